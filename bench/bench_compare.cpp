@@ -0,0 +1,100 @@
+#include "./compare.h"
+#include "./harness.h"
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compares a run of a benchmark against a stored baseline, both as written by --json, and exits with status 1 if any
+// benchmark got slower. Runs recorded by a different kind of build or with different SIMD kernels are refused with
+// status 2 unless --ignore-context is given, in which case the differences are only warned about. Each {isa} in the
+// baseline's path is replaced by the kernels the current run used, so that every ISA is checked against its own.
+namespace {
+	auto usage(const char* program) -> std::string {
+		return std::string{"usage: "} + program
+		       + " [--min-change=FRACTION] [--alpha=P] [--min-samples=N] [--ignore-context] BASELINE.json"
+		         " CURRENT.json\n";
+	}
+
+	auto parse_number(std::string_view arg, std::string_view value) -> double {
+		try {
+			auto used = std::size_t{0};
+			const auto soln = std::stod(std::string{value}, &used);
+			if (used == value.size() and soln >= 0) {
+				return soln;
+			}
+		} catch (const std::logic_error&) {
+		}
+		throw std::invalid_argument{"expected a non-negative number in " + std::string{arg}};
+	}
+
+	auto load(const std::string& path, fsv::bench::run_context& context) -> std::vector<fsv::bench::result> {
+		auto file = std::ifstream{path};
+		if (not file) {
+			throw std::invalid_argument{"cannot open " + path};
+		}
+		return fsv::bench::read_json(file, context);
+	}
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+	auto limits = fsv::bench::thresholds{};
+	auto paths = std::vector<std::string>{};
+	auto ignore_context = false;
+	try {
+		for (int i = 1; i < argc; ++i) {
+			const auto arg = std::string_view{argv[i]};
+			const auto eq = arg.find('=');
+			const auto key = arg.substr(0, eq);
+			const auto value = eq == std::string_view::npos ? std::string_view{} : arg.substr(eq + 1);
+			if (key == "--min-change") {
+				limits.min_change = parse_number(arg, value);
+			}
+			else if (key == "--alpha") {
+				limits.alpha = parse_number(arg, value);
+			}
+			else if (key == "--min-samples") {
+				limits.min_samples = static_cast<std::size_t>(parse_number(arg, value));
+			}
+			else if (arg == "--ignore-context") {
+				ignore_context = true;
+			}
+			else if (arg.starts_with("--")) {
+				throw std::invalid_argument{"unknown option " + std::string{arg}};
+			}
+			else {
+				paths.emplace_back(arg);
+			}
+		}
+		if (paths.size() != 2) {
+			throw std::invalid_argument{"expected a baseline and a current result file"};
+		}
+		auto baseline_context = fsv::bench::run_context{};
+		auto current_context = fsv::bench::run_context{};
+		const auto current = load(paths[1], current_context);
+		const auto baseline = load(fsv::bench::with_isa(paths[0], current_context.isa), baseline_context);
+		const auto differences = fsv::bench::context_differences(baseline_context, current_context);
+		for (const auto& difference : differences) {
+			std::cerr << (ignore_context ? "warning: " : "error: ") << difference << '\n';
+		}
+		if (not differences.empty() and not ignore_context) {
+			std::cerr << "the runs are not comparable; pass --ignore-context to compare them anyway\n";
+			return 2;
+		}
+		const auto rows = fsv::bench::compare(baseline, current, limits);
+		fsv::bench::print_comparison(std::cout, rows);
+		for (const auto& row : rows) {
+			if (row.outcome == fsv::bench::verdict::slower) {
+				return 1;
+			}
+		}
+		return 0;
+	} catch (const std::invalid_argument& e) {
+		std::cerr << e.what() << '\n' << usage(argv[0]);
+		return 2;
+	}
+}
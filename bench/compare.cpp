@@ -0,0 +1,160 @@
+#include "./compare.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace fsv::bench {
+	namespace {
+		auto to_string(verdict v) -> const char* {
+			switch (v) {
+			case verdict::same: return "same";
+			case verdict::faster: return "faster";
+			case verdict::slower: return "SLOWER";
+			case verdict::added: return "added";
+			case verdict::removed: return "removed";
+			}
+			return "";
+		}
+	} // namespace
+
+	auto mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b) -> double {
+		if (a.empty() or b.empty()) {
+			return 1;
+		}
+		// rank the pooled samples, giving ties the mean of the ranks they span
+		auto pooled = std::vector<std::pair<double, bool>>{};
+		pooled.reserve(a.size() + b.size());
+		for (const auto x : a) {
+			pooled.emplace_back(x, true);
+		}
+		for (const auto x : b) {
+			pooled.emplace_back(x, false);
+		}
+		std::sort(pooled.begin(), pooled.end());
+
+		const auto n1 = static_cast<double>(a.size());
+		const auto n2 = static_cast<double>(b.size());
+		const auto n = n1 + n2;
+		double rank_sum_a = 0;
+		double tie_term = 0;
+		for (std::size_t i = 0; i < pooled.size();) {
+			auto j = i;
+			while (j < pooled.size() and pooled[j].first == pooled[i].first) {
+				++j;
+			}
+			const auto t = static_cast<double>(j - i);
+			const auto rank = static_cast<double>(i + j + 1) / 2;
+			for (auto k = i; k < j; ++k) {
+				rank_sum_a += pooled[k].second ? rank : 0;
+			}
+			tie_term += t * t * t - t;
+			i = j;
+		}
+
+		const auto u = rank_sum_a - n1 * (n1 + 1) / 2;
+		const auto mean = n1 * n2 / 2;
+		const auto variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)));
+		if (variance <= 0) {
+			return 1;
+		}
+		// with a continuity correction
+		const auto z = std::max(std::abs(u - mean) - 0.5, 0.0) / std::sqrt(variance);
+		return std::erfc(z / std::sqrt(2.0));
+	}
+
+	auto compare(const std::vector<result>& baseline, const std::vector<result>& current, const thresholds& limits)
+	    -> std::vector<comparison> {
+		auto by_name = std::map<std::string, const result*>{};
+		for (const auto& r : baseline) {
+			by_name.emplace(r.name, &r);
+		}
+
+		auto soln = std::vector<comparison>{};
+		auto seen = std::set<std::string>{};
+		for (const auto& now : current) {
+			seen.insert(now.name);
+			auto row = comparison{};
+			row.name = now.name;
+			const auto found = by_name.find(now.name);
+			if (found == by_name.end() or found->second->samples.empty() or now.samples.empty()) {
+				row.outcome = verdict::added;
+				row.current_ns = now.median();
+				soln.push_back(std::move(row));
+				continue;
+			}
+			const auto& before = *found->second;
+			row.min_of_n = before.samples.size() < limits.min_samples or now.samples.size() < limits.min_samples;
+			// samples are sorted, so the front is the minimum
+			row.baseline_ns = row.min_of_n ? before.samples.front() : before.median();
+			row.current_ns = row.min_of_n ? now.samples.front() : now.median();
+			row.change = row.baseline_ns > 0 ? row.current_ns / row.baseline_ns - 1 : 0;
+			row.p = row.min_of_n ? 0 : mann_whitney_p(before.samples, now.samples);
+			if (std::abs(row.change) > limits.min_change and row.p < limits.alpha) {
+				row.outcome = row.change > 0 ? verdict::slower : verdict::faster;
+			}
+			soln.push_back(std::move(row));
+		}
+		for (const auto& before : baseline) {
+			if (not seen.contains(before.name)) {
+				auto row = comparison{};
+				row.name = before.name;
+				row.outcome = verdict::removed;
+				row.baseline_ns = before.median();
+				soln.push_back(std::move(row));
+			}
+		}
+		return soln;
+	}
+
+	auto context_differences(const run_context& baseline, const run_context& current) -> std::vector<std::string> {
+		auto soln = std::vector<std::string>{};
+		auto build = [](bool optimized) {
+			return std::string{optimized ? "an optimized" : "an unoptimized"} + " build";
+		};
+		if (baseline.optimized != current.optimized) {
+			soln.push_back("baseline is from " + build(baseline.optimized) + ", current run from "
+			               + build(current.optimized));
+		}
+		auto kernels = [](const std::string& isa) { return isa.empty() ? std::string{"unrecorded"} : isa; };
+		if (baseline.isa != current.isa) {
+			soln.push_back("baseline used the " + kernels(baseline.isa) + " kernels, current run the "
+			               + kernels(current.isa) + " kernels");
+		}
+		return soln;
+	}
+
+	void print_comparison(std::ostream& os, const std::vector<comparison>& rows) {
+		os << std::left << std::setw(48) << "benchmark" << std::right << std::setw(14) << "baseline ns" << std::setw(14)
+		   << "current ns" << std::setw(10) << "change" << std::setw(10) << "p" << "  verdict\n";
+		auto counts = std::map<verdict, std::size_t>{};
+		for (const auto& row : rows) {
+			++counts[row.outcome];
+			os << std::left << std::setw(48) << row.name << std::right << std::fixed << std::setprecision(1)
+			   << std::setw(14) << row.baseline_ns << std::setw(14) << row.current_ns;
+			if (row.outcome == verdict::added or row.outcome == verdict::removed) {
+				os << std::setw(10) << "-" << std::setw(10) << "-";
+			}
+			else {
+				os << std::showpos << std::setw(9) << 100 * row.change << '%' << std::noshowpos;
+				if (row.min_of_n) {
+					os << std::setw(10) << "min-of-N";
+				}
+				else {
+					os << std::setprecision(4) << std::setw(10) << row.p;
+				}
+			}
+			os << "  " << to_string(row.outcome) << '\n';
+		}
+		os << rows.size() << " compared:";
+		for (const auto& [v, n] : counts) {
+			os << ' ' << n << ' ' << to_string(v);
+		}
+		os << '\n';
+	}
+} // namespace fsv::bench
@@ -0,0 +1,55 @@
+#ifndef COMP6771_ASS2_BENCH_COMPARE_H
+#define COMP6771_ASS2_BENCH_COMPARE_H
+
+#include "./harness.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace fsv::bench {
+	// Two-sided p-value of the Mann-Whitney U test that a and b are samples of the same distribution, by the normal
+	// approximation with a correction for ties. 1 when either is empty or every sample ties.
+	[[nodiscard]] auto mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b) -> double;
+
+	struct thresholds {
+		// changes in the median smaller than this fraction of the baseline are noise, however significant
+		double min_change = 0.05;
+		// significance level of the Mann-Whitney test
+		double alpha = 0.01;
+		// With fewer samples than this on either side the test cannot reach alpha, so the minimums are compared
+		// instead and any change beyond min_change counts.
+		std::size_t min_samples = 8;
+	};
+
+	enum class verdict { same, faster, slower, added, removed };
+
+	struct comparison {
+		std::string name;
+		verdict outcome = verdict::same;
+		// medians in nanoseconds, or minimums when min_of_n is set; 0 on the side that lacks the benchmark
+		double baseline_ns = 0;
+		double current_ns = 0;
+		// current_ns / baseline_ns - 1
+		double change = 0;
+		double p = 1;
+		bool min_of_n = false;
+	};
+
+	// Matches benchmarks by name: those in both are compared, in the current run's order, followed by the ones only
+	// in the baseline.
+	[[nodiscard]] auto
+	compare(const std::vector<result>& baseline, const std::vector<result>& current, const thresholds& limits)
+	    -> std::vector<comparison>;
+
+	// One line for each way the contexts differ, empty when they match. Times from different builds or different
+	// SIMD kernels are not comparable.
+	[[nodiscard]] auto context_differences(const run_context& baseline, const run_context& current)
+	    -> std::vector<std::string>;
+
+	// one row per benchmark with its times, change, p-value and verdict, then a count of each verdict
+	void print_comparison(std::ostream& os, const std::vector<comparison>& rows);
+} // namespace fsv::bench
+
+#endif // COMP6771_ASS2_BENCH_COMPARE_H
@@ -0,0 +1,133 @@
+#include "./compare.h"
+#include "./harness.h"
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	auto make_result(std::string name, std::vector<double> samples) -> fsv::bench::result {
+		auto soln = fsv::bench::result{};
+		soln.name = std::move(name);
+		soln.bytes = 64;
+		soln.iterations = 1;
+		soln.samples = std::move(samples);
+		return soln;
+	}
+
+	auto outcome_of(const std::vector<fsv::bench::comparison>& rows, const std::string& name) -> fsv::bench::verdict {
+		for (const auto& row : rows) {
+			if (row.name == name) {
+				return row.outcome;
+			}
+		}
+		FAIL("no row for " << name);
+		return fsv::bench::verdict::same;
+	}
+} // namespace
+
+TEST_CASE("mann_whitney_p of separated and identical samples") {
+	auto low = std::vector<double>{};
+	auto high = std::vector<double>{};
+	for (int i = 1; i <= 10; ++i) {
+		low.push_back(i);
+		high.push_back(i + 10);
+	}
+	// U = 0, so z = (50 - 0.5) / sqrt(100 * 21 / 12)
+	CHECK(fsv::bench::mann_whitney_p(low, high) == Approx(0.000183).epsilon(0.01));
+	CHECK(fsv::bench::mann_whitney_p(high, low) == Approx(0.000183).epsilon(0.01));
+	CHECK(fsv::bench::mann_whitney_p(low, low) == Approx(1.0));
+	CHECK(fsv::bench::mann_whitney_p(std::vector<double>(5, 3.0), std::vector<double>(5, 3.0)) == 1.0);
+	CHECK(fsv::bench::mann_whitney_p({}, low) == 1.0);
+}
+
+TEST_CASE("compare needs both a significant and a large enough change") {
+	auto steady = std::vector<double>{100, 101, 102, 103, 104, 105, 106, 107, 108, 109};
+	auto slower = std::vector<double>{120, 121, 122, 123, 124, 125, 126, 127, 128, 129};
+	auto tight = std::vector<double>{100, 100.1, 100.2, 100.3, 100.4, 100.5, 100.6, 100.7, 100.8, 100.9};
+	auto slightly = std::vector<double>{103, 103.1, 103.2, 103.3, 103.4, 103.5, 103.6, 103.7, 103.8, 103.9};
+	auto noisy = std::vector<double>{60, 70, 80, 90, 100, 120, 130, 140, 150, 160};
+	auto baseline = std::vector{make_result("a", steady),
+	                            make_result("b", tight),
+	                            make_result("c", steady),
+	                            make_result("d", slower),
+	                            make_result("gone", steady)};
+	auto current = std::vector{make_result("a", slower),
+	                           make_result("b", slightly),
+	                           make_result("c", noisy),
+	                           make_result("d", steady),
+	                           make_result("new", steady)};
+	const auto rows = fsv::bench::compare(baseline, current, fsv::bench::thresholds{});
+	CHECK(rows.size() == 6);
+	CHECK(outcome_of(rows, "a") == fsv::bench::verdict::slower);
+	// significant, but under the minimum change
+	CHECK(outcome_of(rows, "b") == fsv::bench::verdict::same);
+	// a large change in the median that the test cannot tell from noise
+	CHECK(outcome_of(rows, "c") == fsv::bench::verdict::same);
+	CHECK(outcome_of(rows, "d") == fsv::bench::verdict::faster);
+	CHECK(outcome_of(rows, "new") == fsv::bench::verdict::added);
+	CHECK(outcome_of(rows, "gone") == fsv::bench::verdict::removed);
+	CHECK(rows.back().name == "gone");
+
+	auto os = std::ostringstream{};
+	fsv::bench::print_comparison(os, rows);
+	CHECK(os.str().find("SLOWER") != std::string::npos);
+}
+
+TEST_CASE("compare falls back to the minimums with few samples") {
+	auto baseline = std::vector{make_result("a", {100, 150, 200}), make_result("b", {100, 150, 200})};
+	auto current = std::vector{make_result("a", {104, 300, 400}), make_result("b", {110, 111, 112})};
+	const auto rows = fsv::bench::compare(baseline, current, fsv::bench::thresholds{});
+	REQUIRE(rows.size() == 2);
+	CHECK(rows[0].min_of_n);
+	CHECK(rows[0].outcome == fsv::bench::verdict::same);
+	CHECK(rows[1].outcome == fsv::bench::verdict::slower);
+	CHECK(rows[1].change == Approx(0.1));
+}
+
+TEST_CASE("read_json reads back what write_json wrote") {
+	auto written = std::vector{make_result("size/\"quoted\"\\n", {3.5, 1.25, 2}), make_result("empty", {})};
+	written[0].params = {{"op", "size"}, {"selectivity", "50"}};
+	auto os = std::ostringstream{};
+	fsv::bench::write_json(os, fsv::bench::options{}, written);
+
+	auto is = std::istringstream{os.str()};
+	const auto read = fsv::bench::read_json(is);
+	REQUIRE(read.size() == 2);
+	CHECK(read[0].name == written[0].name);
+	CHECK(read[0].params == written[0].params);
+	CHECK(read[0].bytes == 64);
+	CHECK(read[0].samples == std::vector<double>{1.25, 2, 3.5});
+	CHECK(read[1].samples.empty());
+
+	auto bad = std::istringstream{"{\"benchmarks\": [}"};
+	CHECK_THROWS_AS(fsv::bench::read_json(bad), std::invalid_argument);
+}
+
+TEST_CASE("the context is read back and compared") {
+	auto os = std::ostringstream{};
+	fsv::bench::write_json(os, fsv::bench::options{}, {make_result("size", {1})});
+	auto is = std::istringstream{os.str()};
+	auto context = fsv::bench::run_context{};
+	CHECK(fsv::bench::read_json(is, context).size() == 1);
+	CHECK(not context.isa.empty());
+	CHECK(fsv::bench::context_differences(context, context).empty());
+
+	auto release_avx512 = fsv::bench::run_context{true, "avx512"};
+	CHECK(fsv::bench::context_differences(release_avx512, {true, "avx2"}).size() == 1);
+	CHECK(fsv::bench::context_differences(release_avx512, {false, "avx512"}).size() == 1);
+	CHECK(fsv::bench::context_differences(release_avx512, {false, ""}).size() == 2);
+
+	auto no_context = std::istringstream{"{\"benchmarks\": []}"};
+	CHECK(fsv::bench::read_json(no_context, context).empty());
+	CHECK(context.isa.empty());
+	CHECK(not context.optimized);
+}
+
+TEST_CASE("with_isa names a file for each set of kernels") {
+	CHECK(fsv::bench::with_isa("bench/baselines/matrix.{isa}.json", "avx2") == "bench/baselines/matrix.avx2.json");
+	CHECK(fsv::bench::with_isa("{isa}/{isa}", "sse4.2") == "sse4.2/sse4.2");
+	CHECK(fsv::bench::with_isa("matrix.json", "avx512") == "matrix.json");
+}
@@ -0,0 +1,154 @@
+#include "../src/filtered_string_view.h"
+#include "./harness.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+	// Words of 1 to 12 lowercase letters separated by spaces, in lines of about 60 bytes with a blank line every
+	// eighth line, so that about one byte in six is a space and split() on "\n\n" yields paragraphs.
+	auto make_text(std::size_t length) -> std::string {
+		auto soln = std::string{};
+		soln.reserve(length);
+		auto rng = std::mt19937_64{6771};
+		auto word = std::uniform_int_distribution<std::size_t>{1, 12};
+		auto letter = std::uniform_int_distribution<int>{'a', 'z'};
+		std::size_t line = 0;
+		std::size_t column = 0;
+		while (soln.size() < length) {
+			for (auto n = word(rng); n > 0 and soln.size() < length; --n) {
+				soln.push_back(static_cast<char>(letter(rng)));
+				++column;
+			}
+			if (column < 60) {
+				soln.push_back(' ');
+				++column;
+			}
+			else {
+				soln.append(++line % 8 == 0 ? "\n\n" : "\n");
+				column = 0;
+			}
+		}
+		soln.resize(length);
+		return soln;
+	}
+
+	// Counts what is written to it and throws the bytes away, so that operator<< is timed without the cost of
+	// growing a string.
+	class null_buffer : public std::streambuf {
+	 public:
+		[[nodiscard]] auto count() const noexcept -> std::size_t {
+			return count_;
+		}
+
+	 protected:
+		auto overflow(int_type c) -> int_type override {
+			++count_;
+			return traits_type::not_eof(c);
+		}
+		auto xsputn(const char_type*, std::streamsize n) -> std::streamsize override {
+			count_ += static_cast<std::size_t>(n);
+			return n;
+		}
+
+	 private:
+		std::size_t count_ = 0;
+	};
+
+	void run_operations(fsv::bench::runner& runner,
+	                    const std::string& text,
+	                    const std::string& kind,
+	                    const fsv::filter& pred) {
+		const auto bytes = text.size();
+		const auto suffix = "/" + kind + "/" + std::to_string(bytes);
+		// Views cache their size and index, so each operation gets a fresh view to time the work rather than the
+		// cache. The bounded constructor makes that cost a copy of the predicate and no strlen.
+		auto fresh = [&text, &pred] {
+			return fsv::filtered_string_view{text.data(), text.data() + text.size(), pred};
+		};
+		const auto size = fresh().size();
+
+		runner.run("construct" + suffix, bytes, [&] {
+			auto constructed = fsv::filtered_string_view{text.c_str(), pred};
+			fsv::bench::do_not_optimize(constructed);
+		});
+		runner.run("size" + suffix, bytes, [&] { fsv::bench::do_not_optimize(fresh().size()); });
+		if (size > 0) {
+			runner.run("at" + suffix, bytes, [&] { fsv::bench::do_not_optimize(fresh().at(size / 2)); });
+		}
+		runner.run("iterate" + suffix, bytes, [&] {
+			std::uint32_t sum = 0;
+			for (const char c : fresh()) {
+				sum += static_cast<unsigned char>(c);
+			}
+			fsv::bench::do_not_optimize(sum);
+		});
+		runner.run("to_string" + suffix, bytes, [&] {
+			auto s = static_cast<std::string>(fresh());
+			fsv::bench::do_not_optimize(s.data());
+		});
+		runner.run("print" + suffix, bytes, [&] {
+			auto buffer = null_buffer{};
+			auto os = std::ostream{&buffer};
+			os << fresh();
+			fsv::bench::do_not_optimize(buffer.count());
+		});
+		// composing is constant time, so the composed view is also sized to make the filters run
+		const auto filters = std::vector<fsv::filter>{pred,
+		                                              [](const char& c) { return c != 'q'; },
+		                                              [](const char& c) { return c != '\n'; }};
+		runner.run("compose" + suffix, bytes, [&] {
+			fsv::bench::do_not_optimize(fsv::compose(fresh(), filters).size());
+		});
+		runner.run("substr" + suffix, bytes, [&] {
+			auto sub = fsv::substr(fresh(), size / 4, size / 2);
+			fsv::bench::do_not_optimize(sub);
+		});
+		const auto delimiter = fsv::filtered_string_view{"\n\n"};
+		runner.run("split" + suffix, bytes, [&] {
+			auto tokens = fsv::split(fresh(), delimiter);
+			fsv::bench::do_not_optimize(tokens.data());
+		});
+	}
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+	auto opts = fsv::bench::options{};
+	try {
+		opts = fsv::bench::parse_options(argc, argv);
+	} catch (const std::invalid_argument& e) {
+		std::cerr << e.what() << '\n' << fsv::bench::usage(argv[0]);
+		return 2;
+	}
+#ifndef __OPTIMIZE__
+	std::cerr << "warning: built without optimisation; configure with -DCMAKE_BUILD_TYPE=Release for real numbers\n";
+#endif
+
+	const auto no_spaces = fsv::filter{[](const char& c) { return c != ' '; }};
+	auto runner = fsv::bench::runner{opts, std::cout};
+	// 16 B to 256 MiB by factors of 16, then 1 GiB, which is not a power of 16
+	auto sizes = std::vector<std::size_t>{};
+	for (std::size_t bytes = 16; bytes <= std::size_t{1} << 28; bytes *= 16) {
+		sizes.push_back(bytes);
+	}
+	sizes.push_back(std::size_t{1} << 30);
+	for (const auto bytes : sizes) {
+		if (bytes > opts.max_bytes) {
+			break;
+		}
+		const auto text = make_text(bytes);
+		run_operations(runner, text, "default", fsv::filtered_string_view::default_predicate);
+		run_operations(runner, text, "filter", no_spaces);
+	}
+	if (not fsv::bench::save_json(opts, runner.results())) {
+		std::cerr << "could not write " << opts.json << '\n';
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,597 @@
+#include "./harness.h"
+
+#include "./perf_counters.h"
+
+#include "../src/scan_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <istream>
+#include <locale>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace fsv::bench {
+	namespace {
+		auto parse_count(std::string_view arg, std::string_view value) -> std::size_t {
+			std::size_t soln = 0;
+			if (value.empty()) {
+				throw std::invalid_argument{"expected a number in " + std::string{arg}};
+			}
+			for (const char c : value) {
+				if (c < '0' or c > '9') {
+					throw std::invalid_argument{"expected a number in " + std::string{arg}};
+				}
+				soln = 10 * soln + static_cast<std::size_t>(c - '0');
+			}
+			return soln;
+		}
+
+		auto quoted(std::string_view s) -> std::string {
+			auto soln = std::string{'"'};
+			for (const char c : s) {
+				if (c == '"' or c == '\\') {
+					soln += '\\';
+					soln += c;
+				}
+				else if (static_cast<unsigned char>(c) < 0x20) {
+					constexpr auto hex = std::string_view{"0123456789abcdef"};
+					soln += "\\u00";
+					soln += hex[static_cast<unsigned char>(c) >> 4];
+					soln += hex[static_cast<unsigned char>(c) & 0xf];
+				}
+				else {
+					soln += c;
+				}
+			}
+			return soln + '"';
+		}
+
+		auto isa_name(detail::simd::isa level) -> std::string_view {
+			switch (level) {
+			case detail::simd::isa::scalar: return "scalar";
+			case detail::simd::isa::sse42: return "sse4.2";
+			case detail::simd::isa::avx2: return "avx2";
+			case detail::simd::isa::avx512: return "avx512";
+			}
+			return "unknown";
+		}
+
+		// A parsed JSON value. Only as much of JSON as read_json needs: no surrogate pairs in \\u escapes.
+		struct json_value {
+			enum class kind { null, boolean, number, string, array, object };
+			kind type = kind::null;
+			bool boolean = false;
+			double number = 0;
+			std::string string;
+			// the elements of an array, or the values of an object's members
+			std::vector<json_value> items;
+			// the names of an object's members, parallel to items
+			std::vector<std::string> keys;
+
+			[[nodiscard]] auto find(std::string_view key) const noexcept -> const json_value* {
+				for (std::size_t i = 0; i < keys.size(); ++i) {
+					if (keys[i] == key) {
+						return &items[i];
+					}
+				}
+				return nullptr;
+			}
+
+			[[nodiscard]] auto member(std::string_view key) const -> const json_value& {
+				if (const auto* found = find(key); found != nullptr) {
+					return *found;
+				}
+				throw std::invalid_argument{"missing member \"" + std::string{key} + "\""};
+			}
+		};
+
+		class json_parser {
+		 public:
+			explicit json_parser(std::string_view text) noexcept
+			: text_{text} {}
+
+			auto parse() -> json_value {
+				auto soln = value();
+				skip_space();
+				if (pos_ != text_.size()) {
+					fail("trailing characters");
+				}
+				return soln;
+			}
+
+		 private:
+			[[noreturn]] void fail(const std::string& what) const {
+				throw std::invalid_argument{"JSON: " + what + " at offset " + std::to_string(pos_)};
+			}
+
+			void skip_space() noexcept {
+				while (pos_ < text_.size()
+				       and (text_[pos_] == ' ' or text_[pos_] == '\n' or text_[pos_] == '\r' or text_[pos_] == '\t')) {
+					++pos_;
+				}
+			}
+
+			auto peek() -> char {
+				skip_space();
+				if (pos_ == text_.size()) {
+					fail("unexpected end");
+				}
+				return text_[pos_];
+			}
+
+			void expect(char c) {
+				if (peek() != c) {
+					fail(std::string{"expected '"} + c + "'");
+				}
+				++pos_;
+			}
+
+			auto literal(std::string_view word) -> bool {
+				if (text_.substr(pos_, word.size()) != word) {
+					fail("unexpected character");
+				}
+				pos_ += word.size();
+				return true;
+			}
+
+			auto value() -> json_value {
+				auto soln = json_value{};
+				switch (peek()) {
+				case '{':
+					soln.type = json_value::kind::object;
+					++pos_;
+					if (peek() == '}') {
+						++pos_;
+						return soln;
+					}
+					for (;;) {
+						if (peek() != '"') {
+							fail("expected a member name");
+						}
+						soln.keys.push_back(string());
+						expect(':');
+						soln.items.push_back(value());
+						if (peek() == '}') {
+							++pos_;
+							return soln;
+						}
+						expect(',');
+					}
+				case '[':
+					soln.type = json_value::kind::array;
+					++pos_;
+					if (peek() == ']') {
+						++pos_;
+						return soln;
+					}
+					for (;;) {
+						soln.items.push_back(value());
+						if (peek() == ']') {
+							++pos_;
+							return soln;
+						}
+						expect(',');
+					}
+				case '"':
+					soln.type = json_value::kind::string;
+					soln.string = string();
+					return soln;
+				case 't':
+					soln.type = json_value::kind::boolean;
+					soln.boolean = literal("true");
+					return soln;
+				case 'f':
+					soln.type = json_value::kind::boolean;
+					soln.boolean = not literal("false");
+					return soln;
+				case 'n':
+					literal("null");
+					return soln;
+				default:
+					soln.type = json_value::kind::number;
+					soln.number = number();
+					return soln;
+				}
+			}
+
+			auto string() -> std::string {
+				auto soln = std::string{};
+				++pos_;
+				for (;;) {
+					if (pos_ >= text_.size()) {
+						fail("unterminated string");
+					}
+					const char c = text_[pos_++];
+					if (c == '"') {
+						return soln;
+					}
+					if (c != '\\') {
+						soln += c;
+						continue;
+					}
+					if (pos_ >= text_.size()) {
+						fail("unterminated string");
+					}
+					switch (const char e = text_[pos_++]; e) {
+					case 'b': soln += '\b'; break;
+					case 'f': soln += '\f'; break;
+					case 'n': soln += '\n'; break;
+					case 'r': soln += '\r'; break;
+					case 't': soln += '\t'; break;
+					case 'u': append_utf8(soln, hex4()); break;
+					default: soln += e; break;
+					}
+				}
+			}
+
+			auto hex4() -> unsigned {
+				unsigned soln = 0;
+				for (int i = 0; i < 4; ++i, ++pos_) {
+					const char c = pos_ < text_.size() ? text_[pos_] : '\0';
+					const auto digit = std::string_view{"0123456789abcdef"}.find(static_cast<char>(c | 0x20));
+					if (digit == std::string_view::npos) {
+						fail("bad \\u escape");
+					}
+					soln = 16 * soln + static_cast<unsigned>(digit);
+				}
+				return soln;
+			}
+
+			static void append_utf8(std::string& out, unsigned code) {
+				if (code < 0x80) {
+					out += static_cast<char>(code);
+				}
+				else if (code < 0x800) {
+					out += static_cast<char>(0xc0 | code >> 6);
+					out += static_cast<char>(0x80 | (code & 0x3f));
+				}
+				else {
+					out += static_cast<char>(0xe0 | code >> 12);
+					out += static_cast<char>(0x80 | (code >> 6 & 0x3f));
+					out += static_cast<char>(0x80 | (code & 0x3f));
+				}
+			}
+
+			auto number() -> double {
+				constexpr auto number_chars = std::string_view{"+-.0123456789eE"};
+				const auto first = pos_;
+				while (pos_ < text_.size() and number_chars.find(text_[pos_]) != std::string_view::npos) {
+					++pos_;
+				}
+				if (first == pos_) {
+					fail("unexpected character");
+				}
+				auto in = std::istringstream{std::string{text_.substr(first, pos_ - first)}};
+				in.imbue(std::locale::classic());
+				double soln = 0;
+				if (not(in >> soln) or in.peek() != std::istringstream::traits_type::eof()) {
+					pos_ = first;
+					fail("bad number");
+				}
+				return soln;
+			}
+
+			std::string_view text_;
+			std::size_t pos_ = 0;
+		};
+
+		auto counter(const result& r, perf_counters::event e) -> std::optional<double> {
+			for (const auto& [name, value] : r.counters) {
+				if (name == perf_counters::name(e)) {
+					return value;
+				}
+			}
+			return std::nullopt;
+		}
+
+		// the columns --perf adds, all but IPC per byte
+		void print_counter_header(std::ostream& os) {
+			os << std::setw(10) << "cyc/B" << std::setw(8) << "IPC" << std::setw(12) << "brmiss/B" << std::setw(12)
+			   << "L1dmiss/B" << std::setw(12) << "LLCmiss/B";
+		}
+
+		void print_counters(std::ostream& os, const result& r) {
+			using event = perf_counters::event;
+			const auto bytes = static_cast<double>(std::max(r.bytes, std::size_t{1}));
+			auto column = [&os](int width, int precision, std::optional<double> value) {
+				if (value) {
+					os << std::setprecision(precision) << std::setw(width) << *value;
+				}
+				else {
+					os << std::setw(width) << "-";
+				}
+			};
+			auto per_byte = [&](event e) {
+				const auto value = counter(r, e);
+				return value ? std::optional{*value / bytes} : std::nullopt;
+			};
+			const auto cycles = counter(r, event::cycles);
+			const auto instructions = counter(r, event::instructions);
+			const auto ipc =
+			    cycles and instructions and *cycles > 0 ? std::optional{*instructions / *cycles} : std::nullopt;
+			column(10, 3, per_byte(event::cycles));
+			column(8, 2, ipc);
+			column(12, 5, per_byte(event::branch_misses));
+			column(12, 5, per_byte(event::l1d_misses));
+			column(12, 5, per_byte(event::llc_misses));
+		}
+
+		void print_header(std::ostream& os, bool perf) {
+			os << std::left << std::setw(48) << "benchmark" << std::right << std::setw(12) << "bytes" << std::setw(12)
+			   << "iterations" << std::setw(14) << "median ns" << std::setw(14) << "p99 ns" << std::setw(12) << "GB/s";
+			if (perf) {
+				print_counter_header(os);
+			}
+			os << '\n';
+		}
+
+		void print_row(std::ostream& os, const result& r, bool perf) {
+			os << std::left << std::setw(48) << r.name << std::right << std::setw(12) << r.bytes << std::setw(12)
+			   << r.iterations << std::fixed << std::setprecision(1) << std::setw(14) << r.median() << std::setw(14)
+			   << r.p99() << std::setprecision(3) << std::setw(12) << r.bytes_per_second() / 1e9;
+			if (perf) {
+				print_counters(os, r);
+			}
+			os << std::endl;
+		}
+	} // namespace
+
+	auto parse_options(int argc, const char* const* argv) -> options {
+		auto soln = options{};
+		for (int i = 1; i < argc; ++i) {
+			const auto arg = std::string_view{argv[i]};
+			const auto eq = arg.find('=');
+			const auto key = arg.substr(0, eq);
+			const auto value = eq == std::string_view::npos ? std::string_view{} : arg.substr(eq + 1);
+			if (key == "--warmup") {
+				soln.warmup = parse_count(arg, value);
+			}
+			else if (key == "--repetitions") {
+				soln.repetitions = std::max(parse_count(arg, value), std::size_t{1});
+			}
+			else if (key == "--min-time-ms") {
+				soln.min_time = std::chrono::milliseconds{parse_count(arg, value)};
+			}
+			else if (key == "--max-bytes") {
+				soln.max_bytes = parse_count(arg, value);
+			}
+			else if (key == "--filter") {
+				soln.filter = std::string{value};
+			}
+			else if (key == "--json") {
+				soln.json = std::string{value};
+			}
+			else if (arg == "--perf") {
+				soln.perf = true;
+			}
+			else {
+				throw std::invalid_argument{"unknown option " + std::string{arg}};
+			}
+		}
+		return soln;
+	}
+
+	auto usage(const char* program) -> std::string {
+		return std::string{"usage: "} + program
+		       + " [--warmup=N] [--repetitions=N] [--min-time-ms=N] [--max-bytes=N] [--filter=SUBSTRING]"
+		       " [--json=PATH] [--perf]\n";
+	}
+
+	auto result::median() const -> double {
+		if (samples.empty()) {
+			return 0;
+		}
+		const auto mid = samples.size() / 2;
+		return samples.size() % 2 == 1 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+	}
+
+	auto result::p99() const -> double {
+		if (samples.empty()) {
+			return 0;
+		}
+		const auto rank = static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(samples.size())));
+		return samples[std::max(rank, std::size_t{1}) - 1];
+	}
+
+	auto result::bytes_per_second() const -> double {
+		const auto ns = median();
+		return ns > 0 ? static_cast<double>(bytes) * 1e9 / ns : 0;
+	}
+
+	runner::runner(options opts, std::ostream& out)
+	: opts_{std::move(opts)}
+	, out_{&out} {
+		if (not opts_.perf) {
+			return;
+		}
+		counters_ = std::make_unique<perf_counters>();
+		if (not counters_->errors().empty()) {
+			std::cerr << "warning: some performance counters are unavailable and will be reported as -\n"
+			          << counters_->errors();
+		}
+		if (not counters_->any_available()) {
+			counters_.reset();
+		}
+	}
+
+	runner::~runner() = default;
+
+	auto runner::selected(const std::string& name, std::size_t bytes) const -> bool {
+		return bytes <= opts_.max_bytes and name.find(opts_.filter) != std::string::npos;
+	}
+
+	auto runner::results() const noexcept -> const std::vector<result>& {
+		return results_;
+	}
+
+	void runner::record(const std::string& name, std::size_t bytes, parameters params, const batch& timed) {
+		// Calibrate: grow the batch until it lasts min_time, by at most tenfold a step so that a first call that
+		// happens to be quick does not overshoot. This doubles as the first warmup.
+		std::size_t iterations = 1;
+		for (;;) {
+			const auto elapsed = timed(iterations);
+			if (elapsed >= opts_.min_time) {
+				break;
+			}
+			const auto wanted = 1.4 * static_cast<double>(opts_.min_time.count())
+			                    / static_cast<double>(std::max(elapsed.count(), std::chrono::nanoseconds::rep{1}));
+			iterations *= static_cast<std::size_t>(std::clamp(std::ceil(wanted), 2.0, 10.0));
+		}
+		for (std::size_t i = 0; i < opts_.warmup; ++i) {
+			static_cast<void>(timed(iterations));
+		}
+
+		auto r = result{name, std::move(params), bytes, iterations, {}, {}};
+		r.samples.reserve(opts_.repetitions);
+		// totals over the recorded repetitions, left empty for an event that missed any of them
+		auto totals = perf_counters::readings{};
+		totals.fill(0.0);
+		for (std::size_t i = 0; i < opts_.repetitions; ++i) {
+			if (counters_) {
+				counters_->start();
+			}
+			const auto elapsed = timed(iterations);
+			if (counters_) {
+				const auto counts = counters_->stop();
+				for (std::size_t e = 0; e < perf_counters::event_count; ++e) {
+					totals[e] = (totals[e] and counts[e]) ? std::optional{*totals[e] + *counts[e]} : std::nullopt;
+				}
+			}
+			r.samples.push_back(static_cast<double>(elapsed.count()) / static_cast<double>(iterations));
+		}
+		std::sort(r.samples.begin(), r.samples.end());
+		if (counters_) {
+			const auto runs = static_cast<double>(opts_.repetitions * iterations);
+			for (std::size_t e = 0; e < perf_counters::event_count; ++e) {
+				if (totals[e]) {
+					const auto name = perf_counters::name(static_cast<perf_counters::event>(e));
+					r.counters.emplace_back(std::string{name}, *totals[e] / runs);
+				}
+			}
+		}
+
+		if (results_.empty()) {
+			print_header(*out_, opts_.perf);
+		}
+		print_row(*out_, r, opts_.perf);
+		results_.push_back(std::move(r));
+	}
+
+	void write_json(std::ostream& os, const options& opts, const std::vector<result>& results) {
+		auto out = std::ostringstream{};
+		out << std::setprecision(10);
+#ifdef __OPTIMIZE__
+		constexpr bool optimized = true;
+#else
+		constexpr bool optimized = false;
+#endif
+		out << "{\n  \"context\": {\"optimized\": " << std::boolalpha << optimized
+		    << ", \"isa\": " << quoted(isa_name(detail::simd::detected_isa())) << ", \"warmup\": " << opts.warmup
+		    << ", \"repetitions\": " << opts.repetitions
+		    << ", \"min_time_ns\": " << opts.min_time.count() << ", \"perf\": " << opts.perf
+		    << "},\n  \"benchmarks\": [";
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			const auto& r = results[i];
+			out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << quoted(r.name) << ", \"params\": {";
+			for (std::size_t j = 0; j < r.params.size(); ++j) {
+				out << (j == 0 ? "" : ", ") << quoted(r.params[j].first) << ": " << quoted(r.params[j].second);
+			}
+			out << "}, \"bytes\": " << r.bytes << ", \"iterations\": " << r.iterations
+			    << ", \"median_ns\": " << r.median() << ", \"p99_ns\": " << r.p99()
+			    << ", \"bytes_per_second\": " << r.bytes_per_second() << ", \"samples_ns\": [";
+			for (std::size_t j = 0; j < r.samples.size(); ++j) {
+				out << (j == 0 ? "" : ", ") << r.samples[j];
+			}
+			out << "]";
+			if (not r.counters.empty()) {
+				out << ", \"counters\": {";
+				for (std::size_t j = 0; j < r.counters.size(); ++j) {
+					out << (j == 0 ? "" : ", ") << quoted(r.counters[j].first) << ": " << r.counters[j].second;
+				}
+				out << "}";
+			}
+			out << "}";
+		}
+		out << "\n  ]\n}\n";
+		os << out.str();
+	}
+
+	auto with_isa(std::string path, std::string_view isa) -> std::string {
+		constexpr auto placeholder = std::string_view{"{isa}"};
+		auto pos = path.find(placeholder);
+		while (pos != std::string::npos) {
+			path.replace(pos, placeholder.size(), isa);
+			pos = path.find(placeholder, pos + isa.size());
+		}
+		return path;
+	}
+
+	auto save_json(const options& opts, const std::vector<result>& results) -> bool {
+		if (opts.json.empty()) {
+			return true;
+		}
+		auto file = std::ofstream{with_isa(opts.json, isa_name(detail::simd::detected_isa()))};
+		write_json(file, opts, results);
+		file.close();
+		return static_cast<bool>(file);
+	}
+
+	auto read_json(std::istream& is) -> std::vector<result> {
+		auto context = run_context{};
+		return read_json(is, context);
+	}
+
+	auto read_json(std::istream& is, run_context& context) -> std::vector<result> {
+		auto text = std::string{};
+		auto chunk = std::array<char, 4096>{};
+		while (is.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) or is.gcount() > 0) {
+			text.append(chunk.data(), static_cast<std::size_t>(is.gcount()));
+		}
+		const auto root = json_parser{text}.parse();
+		auto count = [](const json_value& v) {
+			if (v.type != json_value::kind::number or v.number < 0) {
+				throw std::invalid_argument{"JSON: expected a count"};
+			}
+			return static_cast<std::size_t>(v.number);
+		};
+		context = run_context{};
+		if (const auto* recorded = root.find("context"); recorded != nullptr) {
+			if (const auto* optimized = recorded->find("optimized"); optimized != nullptr) {
+				context.optimized = optimized->boolean;
+			}
+			if (const auto* isa = recorded->find("isa"); isa != nullptr) {
+				context.isa = isa->string;
+			}
+		}
+		auto soln = std::vector<result>{};
+		for (const auto& b : root.member("benchmarks").items) {
+			auto r = result{};
+			r.name = b.member("name").string;
+			const auto& params = b.member("params");
+			for (std::size_t i = 0; i < params.keys.size(); ++i) {
+				r.params.emplace_back(params.keys[i], params.items[i].string);
+			}
+			r.bytes = count(b.member("bytes"));
+			r.iterations = count(b.member("iterations"));
+			for (const auto& sample : b.member("samples_ns").items) {
+				r.samples.push_back(sample.number);
+			}
+			if (const auto* counters = b.find("counters"); counters != nullptr) {
+				for (std::size_t i = 0; i < counters->keys.size(); ++i) {
+					r.counters.emplace_back(counters->keys[i], counters->items[i].number);
+				}
+			}
+			std::sort(r.samples.begin(), r.samples.end());
+			soln.push_back(std::move(r));
+		}
+		return soln;
+	}
+} // namespace fsv::bench
@@ -0,0 +1,140 @@
+#ifndef COMP6771_ASS2_BENCH_HARNESS_H
+#define COMP6771_ASS2_BENCH_HARNESS_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fsv::bench {
+	class perf_counters;
+
+	// Makes the compiler assume value is read, so that neither it nor the work that produced it is optimised away.
+	template<typename T>
+	inline void do_not_optimize(const T& value) {
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	// Makes the compiler assume all memory is read and written here, so stores before it are not elided.
+	inline void clobber_memory() {
+		asm volatile("" : : : "memory");
+	}
+
+	struct options {
+		// repetitions that are run and thrown away before any are recorded
+		std::size_t warmup = 2;
+		std::size_t repetitions = 15;
+		// each repetition runs the body as many times as it takes to last at least this long
+		std::chrono::nanoseconds min_time = std::chrono::milliseconds{10};
+		// benchmarks over more bytes than this are skipped
+		std::size_t max_bytes = std::size_t{1} << 30;
+		// only benchmarks whose name contains this are run
+		std::string filter;
+		// where to write the results as JSON, if anywhere; see with_isa for {isa}
+		std::string json;
+		// whether to read hardware performance counters around the recorded repetitions
+		bool perf = false;
+	};
+
+	// Reads --warmup=N, --repetitions=N, --min-time-ms=N, --max-bytes=N, --filter=S, --json=PATH and --perf.
+	// Throws std::invalid_argument on anything else.
+	[[nodiscard]] auto parse_options(int argc, const char* const* argv) -> options;
+	[[nodiscard]] auto usage(const char* program) -> std::string;
+
+	// named parameters of a benchmark, such as the predicate kind, kept in the order given
+	using parameters = std::vector<std::pair<std::string, std::string>>;
+
+	struct result {
+		std::string name;
+		parameters params;
+		// bytes the body processes each time it runs
+		std::size_t bytes = 0;
+		// times the body ran in each repetition
+		std::size_t iterations = 0;
+		// nanoseconds per run of the body, one for each repetition, in ascending order
+		std::vector<double> samples;
+		// With --perf, the mean count of each performance counter event per run of the body, over all repetitions.
+		// Events that could not be counted are left out.
+		std::vector<std::pair<std::string, double>> counters;
+
+		[[nodiscard]] auto median() const -> double;
+		// the 99th percentile by nearest rank, which is the slowest sample when there are fewer than 100
+		[[nodiscard]] auto p99() const -> double;
+		// bytes over the median time
+		[[nodiscard]] auto bytes_per_second() const -> double;
+	};
+
+	// Runs benchmarks one after another and writes a row for each to out as soon as it finishes.
+	class runner {
+	 public:
+		// With opts.perf, opens the performance counters and warns on std::cerr about any that are unavailable.
+		runner(options opts, std::ostream& out);
+		runner(const runner&) = delete;
+		auto operator=(const runner&) -> runner& = delete;
+		~runner();
+
+		[[nodiscard]] auto selected(const std::string& name, std::size_t bytes) const -> bool;
+
+		// Times body, which processes the given number of bytes each time it is called, unless the options
+		// exclude it.
+		template<typename F>
+		void run(const std::string& name, std::size_t bytes, F&& body) {
+			run(name, bytes, parameters{}, std::forward<F>(body));
+		}
+
+		// as above, recording params with the result
+		template<typename F>
+		void run(const std::string& name, std::size_t bytes, parameters params, F&& body) {
+			if (not selected(name, bytes)) {
+				return;
+			}
+			record(name, bytes, std::move(params), [&body](std::size_t iterations) {
+				const auto start = std::chrono::steady_clock::now();
+				for (std::size_t i = 0; i < iterations; ++i) {
+					body();
+					clobber_memory();
+				}
+				return std::chrono::steady_clock::now() - start;
+			});
+		}
+
+		[[nodiscard]] auto results() const noexcept -> const std::vector<result>&;
+
+	 private:
+		using batch = std::function<std::chrono::nanoseconds(std::size_t iterations)>;
+
+		void record(const std::string& name, std::size_t bytes, parameters params, const batch& timed);
+
+		options opts_;
+		std::ostream* out_;
+		std::unique_ptr<perf_counters> counters_;
+		std::vector<result> results_;
+	};
+
+	// Replaces each {isa} in path with isa, so that one path names a separate baseline for each set of SIMD kernels.
+	[[nodiscard]] auto with_isa(std::string path, std::string_view isa) -> std::string;
+
+	// Writes the options and every result, with all of its samples, as one JSON object.
+	void write_json(std::ostream& os, const options& opts, const std::vector<result>& results);
+	// writes to opts.json, with {isa} replaced by the kernels in use, when it is set; returns false if the file could
+	// not be written
+	[[nodiscard]] auto save_json(const options& opts, const std::vector<result>& results) -> bool;
+	// what write_json records about the build and machine under "context", which results are only comparable within
+	struct run_context {
+		bool optimized = false;
+		// the SIMD kernels in use, or empty when the file does not say
+		std::string isa;
+	};
+
+	// Reads back the results that write_json wrote. Throws std::invalid_argument if the input is not such a file.
+	[[nodiscard]] auto read_json(std::istream& is) -> std::vector<result>;
+	// as above, also reading the context into context
+	[[nodiscard]] auto read_json(std::istream& is, run_context& context) -> std::vector<result>;
+} // namespace fsv::bench
+
+#endif // COMP6771_ASS2_BENCH_HARNESS_H
@@ -0,0 +1,173 @@
+#include "../src/filtered_string_view.h"
+#include "./harness.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Sweeps the shapes of workload that decide how every operation performs: the fraction of bytes the predicate
+// accepts, whether the accepted bytes come in long runs or are scattered, the size of the buffer and how the
+// predicate is represented. Every cell is reported with its parameters, and --json writes them all out for
+// comparing one version of the library with another.
+namespace {
+	constexpr auto selectivities = std::array<int, 5>{0, 10, 50, 90, 100};
+	constexpr auto sizes = std::array<std::size_t, 3>{std::size_t{4} << 10,
+	                                                  std::size_t{256} << 10,
+	                                                  std::size_t{16} << 20};
+	// mean length of a run of accepted bytes when they are clustered
+	constexpr double mean_run = 64;
+
+	enum class clustering { scattered, runs };
+
+	auto to_string(clustering c) -> std::string {
+		return c == clustering::scattered ? "scattered" : "runs";
+	}
+
+	// Lowercase letters, which the predicates accept, and '-', which they reject. When scattered, each byte is a
+	// letter with probability selectivity / 100; as runs, the letters come in runs of mean length mean_run with
+	// runs of '-' between them long enough to give the same proportion.
+	auto make_buffer(std::size_t length, int selectivity, clustering shape) -> std::string {
+		auto soln = std::string(length, '-');
+		auto rng = std::mt19937_64{6771};
+		auto letter = std::uniform_int_distribution<int>{'a', 'z'};
+		const double p = selectivity / 100.0;
+		if (selectivity == 0) {
+			return soln;
+		}
+		if (shape == clustering::scattered or selectivity == 100) {
+			auto accept = std::bernoulli_distribution{p};
+			for (auto& c : soln) {
+				if (accept(rng)) {
+					c = static_cast<char>(letter(rng));
+				}
+			}
+			return soln;
+		}
+		auto accepted_run = std::geometric_distribution<std::size_t>{1 / mean_run};
+		auto rejected_run = std::geometric_distribution<std::size_t>{p / (mean_run * (1 - p))};
+		for (std::size_t i = 0; i < length;) {
+			for (auto n = accepted_run(rng) + 1; n > 0 and i < length; --n, ++i) {
+				soln[i] = static_cast<char>(letter(rng));
+			}
+			i += rejected_run(rng) + 1;
+		}
+		return soln;
+	}
+
+	class null_buffer : public std::streambuf {
+	 protected:
+		auto overflow(int_type c) -> int_type override {
+			return traits_type::not_eof(c);
+		}
+		auto xsputn(const char_type*, std::streamsize n) -> std::streamsize override {
+			return n;
+		}
+	};
+
+	// Times each operation on a fresh view from make_view, so that no cached size or index carries over from one
+	// call to the next.
+	template<typename MakeView>
+	void run_cell(fsv::bench::runner& runner,
+	              const std::string& suffix,
+	              const fsv::bench::parameters& params,
+	              std::size_t bytes,
+	              MakeView make_view) {
+		auto run = [&](const std::string& op, auto body) {
+			auto with_op = params;
+			with_op.insert(with_op.begin(), std::pair{std::string{"op"}, op});
+			runner.run(op + suffix, bytes, std::move(with_op), body);
+		};
+		const auto size = make_view().size();
+
+		run("size", [&] { fsv::bench::do_not_optimize(make_view().size()); });
+		if (size > 0) {
+			run("at", [&] { fsv::bench::do_not_optimize(make_view().at(size / 2)); });
+		}
+		run("iterate", [&] {
+			std::uint32_t sum = 0;
+			for (const char c : make_view()) {
+				sum += static_cast<unsigned char>(c);
+			}
+			fsv::bench::do_not_optimize(sum);
+		});
+		run("to_string", [&] {
+			auto s = static_cast<std::string>(make_view());
+			fsv::bench::do_not_optimize(s.data());
+		});
+		run("print", [&] {
+			auto buffer = null_buffer{};
+			auto os = std::ostream{&buffer};
+			os << make_view();
+			fsv::bench::do_not_optimize(os.rdstate());
+		});
+		run("equal", [&] { fsv::bench::do_not_optimize(make_view() == make_view()); });
+	}
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+	auto opts = fsv::bench::options{};
+	try {
+		opts = fsv::bench::parse_options(argc, argv);
+	} catch (const std::invalid_argument& e) {
+		std::cerr << e.what() << '\n' << fsv::bench::usage(argv[0]);
+		return 2;
+	}
+#ifndef __OPTIMIZE__
+	std::cerr << "warning: built without optimisation; configure with -DCMAKE_BUILD_TYPE=Release for real numbers\n";
+#endif
+
+	const auto no_dashes = fsv::filter{[](const char& c) { return c != '-'; }};
+	// the same predicate as a chain of three, with the one that rejects anything last so that every link runs
+	const auto chain = std::vector<fsv::filter>{[](const char& c) { return c != '\n'; },
+	                                            [](const char& c) { return c != '\r'; },
+	                                            no_dashes};
+
+	auto runner = fsv::bench::runner{opts, std::cout};
+	for (const auto bytes : sizes) {
+		if (bytes > opts.max_bytes) {
+			continue;
+		}
+		for (const auto shape : {clustering::scattered, clustering::runs}) {
+			for (const auto selectivity : selectivities) {
+				const auto buffer = make_buffer(bytes, selectivity, shape);
+				const auto* first = buffer.data();
+				const auto* last = buffer.data() + buffer.size();
+				auto cell = [&](const std::string& kind, std::size_t cell_bytes, auto make_view) {
+					const auto suffix = "/" + kind + "/" + to_string(shape) + "/s" + std::to_string(selectivity) + "/"
+					                    + std::to_string(bytes);
+					const auto params = fsv::bench::parameters{{"predicate", kind},
+					                                           {"clustering", to_string(shape)},
+					                                           {"selectivity", std::to_string(selectivity)},
+					                                           {"bytes", std::to_string(bytes)}};
+					run_cell(runner, suffix, params, cell_bytes, make_view);
+				};
+
+				// the default predicate accepts every byte, which only matches the buffer when all are letters
+				if (selectivity == 100) {
+					cell("default", bytes, [=] { return fsv::filtered_string_view{first, last}; });
+				}
+				cell("lambda", bytes, [&] { return fsv::filtered_string_view{first, last, no_dashes}; });
+				cell("composed", bytes, [&] { return fsv::compose(fsv::filtered_string_view{first, last}, chain); });
+				// substr() of a fresh lambda view, dropping the first accepted byte if there is one, so that each
+				// operation is timed together with the substr() it consumes and no size or index of the whole view
+				// carries over
+				const auto pos = fsv::filtered_string_view{first, last, no_dashes}.empty() ? 0 : 1;
+				cell("substr", bytes, [&] {
+					return fsv::substr(fsv::filtered_string_view{first, last, no_dashes}, pos);
+				});
+			}
+		}
+	}
+	if (not fsv::bench::save_json(opts, runner.results())) {
+		std::cerr << "could not write " << opts.json << '\n';
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,153 @@
+#include "./perf_counters.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#ifdef __linux__
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+namespace fsv::bench {
+	namespace {
+		constexpr auto all_events = std::array{perf_counters::event::cycles,
+		                                       perf_counters::event::instructions,
+		                                       perf_counters::event::branch_misses,
+		                                       perf_counters::event::l1d_misses,
+		                                       perf_counters::event::llc_misses};
+
+		auto index(perf_counters::event e) noexcept -> std::size_t {
+			return static_cast<std::size_t>(e);
+		}
+
+#ifdef __linux__
+		auto attributes(perf_counters::event e) noexcept -> perf_event_attr {
+			constexpr auto read_miss = [](std::uint64_t cache) -> std::uint64_t {
+				return cache | std::uint64_t{PERF_COUNT_HW_CACHE_OP_READ} << 8
+				       | std::uint64_t{PERF_COUNT_HW_CACHE_RESULT_MISS} << 16;
+			};
+			auto soln = perf_event_attr{};
+			soln.size = sizeof(soln);
+			switch (e) {
+			case perf_counters::event::cycles:
+				soln.type = PERF_TYPE_HARDWARE;
+				soln.config = PERF_COUNT_HW_CPU_CYCLES;
+				break;
+			case perf_counters::event::instructions:
+				soln.type = PERF_TYPE_HARDWARE;
+				soln.config = PERF_COUNT_HW_INSTRUCTIONS;
+				break;
+			case perf_counters::event::branch_misses:
+				soln.type = PERF_TYPE_HARDWARE;
+				soln.config = PERF_COUNT_HW_BRANCH_MISSES;
+				break;
+			case perf_counters::event::l1d_misses:
+				soln.type = PERF_TYPE_HW_CACHE;
+				soln.config = read_miss(PERF_COUNT_HW_CACHE_L1D);
+				break;
+			case perf_counters::event::llc_misses:
+				soln.type = PERF_TYPE_HW_CACHE;
+				soln.config = read_miss(PERF_COUNT_HW_CACHE_LL);
+				break;
+			}
+			soln.disabled = 1;
+			soln.exclude_kernel = 1;
+			soln.exclude_hv = 1;
+			soln.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			return soln;
+		}
+#endif
+	} // namespace
+
+	perf_counters::perf_counters() {
+		fds_.fill(-1);
+#ifdef __linux__
+		for (const auto e : all_events) {
+			auto attr = attributes(e);
+			const auto fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+			if (fd < 0) {
+				errors_ += std::string{name(e)} + ": " + std::generic_category().message(errno) + '\n';
+				continue;
+			}
+			fds_[index(e)] = static_cast<int>(fd);
+		}
+#else
+		errors_ = "performance counters need Linux perf_event_open\n";
+#endif
+	}
+
+	perf_counters::~perf_counters() {
+#ifdef __linux__
+		for (const auto fd : fds_) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+#endif
+	}
+
+	auto perf_counters::name(event e) noexcept -> std::string_view {
+		switch (e) {
+		case event::cycles: return "cycles";
+		case event::instructions: return "instructions";
+		case event::branch_misses: return "branch_misses";
+		case event::l1d_misses: return "l1d_misses";
+		case event::llc_misses: return "llc_misses";
+		}
+		return "";
+	}
+
+	auto perf_counters::available(event e) const noexcept -> bool {
+		return fds_[index(e)] >= 0;
+	}
+
+	auto perf_counters::any_available() const noexcept -> bool {
+		for (const auto fd : fds_) {
+			if (fd >= 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	auto perf_counters::errors() const -> const std::string& {
+		return errors_;
+	}
+
+	void perf_counters::start() noexcept {
+#ifdef __linux__
+		for (const auto fd : fds_) {
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+#endif
+	}
+
+	auto perf_counters::stop() noexcept -> readings {
+		auto soln = readings{};
+#ifdef __linux__
+		for (const auto fd : fds_) {
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			}
+		}
+		for (const auto e : all_events) {
+			const auto fd = fds_[index(e)];
+			// value, time enabled, time running
+			auto values = std::array<std::uint64_t, 3>{};
+			if (fd < 0 or read(fd, values.data(), sizeof(values)) != static_cast<ssize_t>(sizeof(values))
+			    or values[2] == 0) {
+				continue;
+			}
+			soln[index(e)] = static_cast<double>(values[0]) * static_cast<double>(values[1])
+			                 / static_cast<double>(values[2]);
+		}
+#endif
+		return soln;
+	}
+} // namespace fsv::bench
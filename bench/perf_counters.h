@@ -0,0 +1,45 @@
+#ifndef COMP6771_ASS2_BENCH_PERF_COUNTERS_H
+#define COMP6771_ASS2_BENCH_PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fsv::bench {
+	// Hardware performance counters of the calling thread, in user space only, read with Linux perf_event_open.
+	// Each event is opened on its own, so those the kernel or a virtual machine does not provide are left out and
+	// the rest still count. Off Linux none are available.
+	class perf_counters {
+	 public:
+		enum class event { cycles, instructions, branch_misses, l1d_misses, llc_misses };
+		static constexpr std::size_t event_count = 5;
+		// indexed by event; empty for an event that is unavailable or was never scheduled
+		using readings = std::array<std::optional<double>, event_count>;
+
+		perf_counters();
+		perf_counters(const perf_counters&) = delete;
+		auto operator=(const perf_counters&) -> perf_counters& = delete;
+		~perf_counters();
+
+		[[nodiscard]] static auto name(event e) noexcept -> std::string_view;
+
+		[[nodiscard]] auto available(event e) const noexcept -> bool;
+		[[nodiscard]] auto any_available() const noexcept -> bool;
+		// why the events that are unavailable could not be opened, one per line; empty when all were
+		[[nodiscard]] auto errors() const -> const std::string&;
+
+		// zeroes the counters and starts them
+		void start() noexcept;
+		// Stops the counters and returns the counts since start(), scaled up for any time the kernel had to
+		// multiplex an event out.
+		[[nodiscard]] auto stop() noexcept -> readings;
+
+	 private:
+		std::array<int, event_count> fds_;
+		std::string errors_;
+	};
+} // namespace fsv::bench
+
+#endif // COMP6771_ASS2_BENCH_PERF_COUNTERS_H
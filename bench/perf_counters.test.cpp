@@ -0,0 +1,92 @@
+#include "./harness.h"
+#include "./perf_counters.h"
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <sstream>
+#include <string>
+
+namespace {
+	constexpr auto all_events = std::array{fsv::bench::perf_counters::event::cycles,
+	                                       fsv::bench::perf_counters::event::instructions,
+	                                       fsv::bench::perf_counters::event::branch_misses,
+	                                       fsv::bench::perf_counters::event::l1d_misses,
+	                                       fsv::bench::perf_counters::event::llc_misses};
+
+	auto busy_work() -> std::uint64_t {
+		std::uint64_t x = 1;
+		for (std::uint64_t i = 0; i < 1'000'000; ++i) {
+			x = x * 6364136223846793005u + i;
+			fsv::bench::do_not_optimize(x);
+		}
+		return x;
+	}
+} // namespace
+
+// Hardware counters are often missing, in virtual machines and containers especially, so these tests check that
+// whatever is available counts and whatever is not is reported as such.
+TEST_CASE("perf_counters reads the events it could open and only those") {
+	auto counters = fsv::bench::perf_counters{};
+	auto names = std::set<std::string>{};
+	bool all_available = true;
+	for (const auto e : all_events) {
+		names.emplace(fsv::bench::perf_counters::name(e));
+		all_available = all_available and counters.available(e);
+	}
+	CHECK(names.size() == all_events.size());
+	CHECK(counters.errors().empty() == all_available);
+
+	counters.start();
+	fsv::bench::do_not_optimize(busy_work());
+	const auto counts = counters.stop();
+	for (const auto e : all_events) {
+		INFO(fsv::bench::perf_counters::name(e));
+		if (not counters.available(e)) {
+			CHECK(not counts[static_cast<std::size_t>(e)].has_value());
+		}
+	}
+	using event = fsv::bench::perf_counters::event;
+	if (const auto& instructions = counts[static_cast<std::size_t>(event::instructions)]; instructions) {
+		CHECK(*instructions > 1'000'000);
+	}
+	if (const auto& cycles = counts[static_cast<std::size_t>(event::cycles)]; cycles) {
+		CHECK(*cycles > 0);
+	}
+}
+
+TEST_CASE("runner records counters per call only with --perf") {
+	const char* argv[] = {"bench", "--perf", "--warmup=0", "--repetitions=2", "--min-time-ms=0"};
+	const auto opts = fsv::bench::parse_options(5, argv);
+	REQUIRE(opts.perf);
+
+	const auto probe = fsv::bench::perf_counters{};
+	auto out = std::ostringstream{};
+	auto runner = fsv::bench::runner{opts, out};
+	runner.run("busy", 64, [] { fsv::bench::do_not_optimize(busy_work()); });
+	REQUIRE(runner.results().size() == 1);
+	const auto& r = runner.results().front();
+	CHECK(out.str().find("cyc/B") != std::string::npos);
+	for (const auto& [name, value] : r.counters) {
+		INFO(name);
+		CHECK(value >= 0);
+	}
+	std::size_t available = 0;
+	for (const auto e : all_events) {
+		available += static_cast<std::size_t>(probe.available(e));
+	}
+	CHECK(r.counters.size() <= available);
+
+	auto plain_out = std::ostringstream{};
+	auto plain_opts = fsv::bench::options{};
+	plain_opts.warmup = 0;
+	plain_opts.repetitions = 1;
+	plain_opts.min_time = {};
+	auto plain = fsv::bench::runner{plain_opts, plain_out};
+	plain.run("busy", 64, [] { fsv::bench::do_not_optimize(busy_work()); });
+	CHECK(plain.results().front().counters.empty());
+	CHECK(plain_out.str().find("cyc/B") == std::string::npos);
+}
@@ -0,0 +1,128 @@
+#ifndef COMP6771_ASS2_CHAR_CLASS_H
+#define COMP6771_ASS2_CHAR_CLASS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace fsv {
+	// A predicate that is a set of byte values. A pure predicate over const char& is fully described by which of the
+	// 256 byte values it accepts, so char_class can stand in for it with a table lookup.
+	//
+	// The 256 bits are stored nibble-transposed: row (lo + 16 * (hi >> 3)) holds, in bit (hi & 7), whether the byte
+	// (hi << 4 | lo) is a member. Each half of the table is then a 16-entry byte lookup keyed by the low nibble, the
+	// shape that pshufb-style SIMD lookups expect.
+	class char_class {
+	 public:
+		static constexpr std::size_t row_count = 32;
+		using rows_type = std::array<std::uint8_t, row_count>;
+
+		constexpr char_class() noexcept = default;
+
+		// the class of every byte value
+		[[nodiscard]] static constexpr auto all() noexcept -> char_class {
+			auto soln = char_class{};
+			soln.rows_.fill(0xff);
+			return soln;
+		}
+
+		[[nodiscard]] constexpr auto operator()(const char& c) const noexcept -> bool {
+			return contains(static_cast<unsigned char>(c));
+		}
+
+		[[nodiscard]] constexpr auto contains(unsigned char byte) const noexcept -> bool {
+			return ((rows_[row_of(byte)] >> (byte >> 4 & 7)) & 1) != 0;
+		}
+
+		constexpr auto insert(unsigned char byte) noexcept -> char_class& {
+			rows_[row_of(byte)] = static_cast<std::uint8_t>(rows_[row_of(byte)] | (1 << (byte >> 4 & 7)));
+			return *this;
+		}
+
+		constexpr auto erase(unsigned char byte) noexcept -> char_class& {
+			rows_[row_of(byte)] = static_cast<std::uint8_t>(rows_[row_of(byte)] & ~(1 << (byte >> 4 & 7)));
+			return *this;
+		}
+
+		[[nodiscard]] constexpr auto count() const noexcept -> std::size_t {
+			std::size_t soln = 0;
+			for (auto row : rows_) {
+				for (; row != 0; row = static_cast<std::uint8_t>(row & (row - 1))) {
+					++soln;
+				}
+			}
+			return soln;
+		}
+
+		[[nodiscard]] constexpr auto rows() const noexcept -> const rows_type& {
+			return rows_;
+		}
+
+		friend constexpr auto operator==(const char_class& lhs, const char_class& rhs) noexcept -> bool = default;
+
+		// intersection, union and complement
+		friend constexpr auto operator&(const char_class& lhs, const char_class& rhs) noexcept -> char_class {
+			auto soln = char_class{};
+			for (std::size_t i = 0; i < row_count; ++i) {
+				soln.rows_[i] = static_cast<std::uint8_t>(lhs.rows_[i] & rhs.rows_[i]);
+			}
+			return soln;
+		}
+		friend constexpr auto operator|(const char_class& lhs, const char_class& rhs) noexcept -> char_class {
+			auto soln = char_class{};
+			for (std::size_t i = 0; i < row_count; ++i) {
+				soln.rows_[i] = static_cast<std::uint8_t>(lhs.rows_[i] | rhs.rows_[i]);
+			}
+			return soln;
+		}
+		friend constexpr auto operator~(const char_class& cls) noexcept -> char_class {
+			auto soln = char_class{};
+			for (std::size_t i = 0; i < row_count; ++i) {
+				soln.rows_[i] = static_cast<std::uint8_t>(~cls.rows_[i]);
+			}
+			return soln;
+		}
+
+	 private:
+		[[nodiscard]] static constexpr auto row_of(unsigned char byte) noexcept -> std::size_t {
+			return static_cast<std::size_t>((byte & 0x0f) | ((byte >> 3) & 0x10));
+		}
+
+		rows_type rows_ = {};
+	};
+
+	// Evaluates the predicate once for each of the 256 byte values and returns the equivalent table. Only meaningful
+	// for predicates whose result depends on nothing but the value of the character.
+	template<typename Pred>
+	[[nodiscard]] constexpr auto probe(const Pred& predicate) -> char_class {
+		auto soln = char_class{};
+		for (std::size_t byte = 0; byte < 256; ++byte) {
+			const auto c = static_cast<char>(static_cast<unsigned char>(byte));
+			if (predicate(c)) {
+				soln.insert(static_cast<unsigned char>(byte));
+			}
+		}
+		return soln;
+	}
+
+	namespace detail {
+		// The table behind a predicate when it is known to be a char_class, either statically or as the target of a
+		// std::function, so that scanning loops can use the table instead of calling through the predicate.
+		template<typename Pred>
+		[[nodiscard]] constexpr auto table_of(const Pred&) noexcept -> const char_class* {
+			return nullptr;
+		}
+
+		[[nodiscard]] constexpr auto table_of(const char_class& predicate) noexcept -> const char_class* {
+			return &predicate;
+		}
+
+		[[nodiscard]] inline auto table_of(const std::function<bool(const char&)>& predicate) noexcept
+		    -> const char_class* {
+			return predicate.target<char_class>();
+		}
+	} // namespace detail
+} // namespace fsv
+
+#endif // COMP6771_ASS2_CHAR_CLASS_H
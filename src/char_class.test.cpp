@@ -0,0 +1,57 @@
+#include "./char_class.h"
+
+#include <catch2/catch.hpp>
+
+#include <cctype>
+
+TEST_CASE("char_class starts empty") {
+	constexpr auto cls = fsv::char_class{};
+	STATIC_REQUIRE(cls.count() == 0);
+	for (int b = 0; b < 256; ++b) {
+		REQUIRE_FALSE(cls.contains(static_cast<unsigned char>(b)));
+	}
+}
+
+TEST_CASE("char_class insert and erase") {
+	auto cls = fsv::char_class{};
+	cls.insert('a').insert(0x80).insert(0xff).insert(0);
+	REQUIRE(cls.count() == 4);
+	REQUIRE(cls('a'));
+	REQUIRE(cls(static_cast<char>(0x80)));
+	REQUIRE(cls(static_cast<char>(0xff)));
+	REQUIRE(cls('\0'));
+	REQUIRE_FALSE(cls('b'));
+
+	cls.erase('a');
+	REQUIRE_FALSE(cls('a'));
+	REQUIRE(cls.count() == 3);
+}
+
+TEST_CASE("probe() reproduces the predicate for every byte") {
+	auto is_alnum = [](const char& c) { return std::isalnum(static_cast<unsigned char>(c)) != 0; };
+	auto cls = fsv::probe(is_alnum);
+	for (int b = 0; b < 256; ++b) {
+		auto c = static_cast<char>(b);
+		REQUIRE(cls(c) == is_alnum(c));
+	}
+	REQUIRE(cls.count() == 62);
+}
+
+TEST_CASE("probe() works on fsv::filter and at compile time") {
+	auto vowel = std::function<bool(const char&)>{[](const char& c) { return c == 'a' || c == 'e' || c == 'i'; }};
+	REQUIRE(fsv::probe(vowel).count() == 3);
+
+	constexpr auto digits = fsv::probe([](const char& c) { return c >= '0' && c <= '9'; });
+	STATIC_REQUIRE(digits.count() == 10);
+	STATIC_REQUIRE(digits('7'));
+}
+
+TEST_CASE("table_of() sees through std::function") {
+	auto cls = fsv::char_class{}.insert('x');
+	auto erased = std::function<bool(const char&)>{cls};
+	REQUIRE(fsv::detail::table_of(erased) != nullptr);
+	REQUIRE(*fsv::detail::table_of(erased) == cls);
+
+	auto opaque = std::function<bool(const char&)>{[](const char& c) { return c == 'x'; }};
+	REQUIRE(fsv::detail::table_of(opaque) == nullptr);
+}
@@ -0,0 +1,137 @@
+#include "./filtered_string_view.h"
+
+#include <catch2/catch.hpp>
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The performance contract: every operation below evaluates the predicate at most a constant number of times per
+// byte of the underlying string, whatever the shape of the input. Each one is run on a fresh view so that the calls
+// that fill a cached size or index are counted too.
+namespace {
+	// Forwards to a predicate and counts the calls in a counter shared with all of its copies, since views and
+	// std::function copy their predicates freely.
+	template<typename Pred>
+	class counting_predicate {
+	 public:
+		counting_predicate(Pred pred, std::size_t& calls)
+		: pred_{std::move(pred)}
+		, calls_{&calls} {}
+
+		auto operator()(const char& c) const -> bool {
+			++*calls_;
+			return static_cast<bool>(pred_(c));
+		}
+
+	 private:
+		Pred pred_;
+		std::size_t* calls_;
+	};
+
+	auto not_space = [](const char& c) { return c != ' '; };
+
+	struct shape {
+		std::string name;
+		std::string text;
+	};
+
+	auto shapes(std::size_t n) -> std::vector<shape> {
+		auto alternating = std::string{};
+		auto words = std::string{};
+		auto sparse = std::string(n, ' ');
+		for (std::size_t i = 0; i < n; ++i) {
+			alternating += i % 2 == 0 ? 'a' : ' ';
+			words += i % 11 < 7 ? static_cast<char>('a' + i % 26) : ' ';
+			if (i % 64 == 63) {
+				sparse[i] = 'z';
+			}
+		}
+		return {{"all accepted", std::string(n, 'x')},
+		        {"none accepted", std::string(n, ' ')},
+		        {"alternating", alternating},
+		        {"words", words},
+		        {"sparse", sparse}};
+	}
+
+	// Calls op on a fresh view from make and checks that it took at most c calls of the predicate per byte, plus a
+	// couple for the boundaries.
+	template<typename MakeView, typename Op>
+	void check_calls(const char* what, std::size_t& calls, std::size_t n, std::size_t c, MakeView make, Op op) {
+		calls = 0;
+		{
+			auto view = make();
+			op(view);
+		}
+		INFO(what << ": " << calls << " predicate calls for " << n << " bytes");
+		CHECK(calls <= c * n + 2);
+	}
+
+	template<typename MakeView>
+	void check_operations(std::size_t& calls, std::size_t n, MakeView make) {
+		check_calls("size()", calls, n, 1, make, [](const auto& v) { static_cast<void>(v.size()); });
+		check_calls("empty()", calls, n, 1, make, [](const auto& v) { static_cast<void>(v.empty()); });
+		check_calls("range-for", calls, n, 1, make, [](const auto& v) {
+			std::size_t count = 0;
+			for (const char c : v) {
+				count += c != ' ';
+			}
+			static_cast<void>(count);
+		});
+		check_calls("reverse iteration", calls, n, 4, make, [](const auto& v) {
+			static_cast<void>(std::distance(v.rbegin(), v.rend()));
+		});
+		check_calls("at() of every index", calls, n, 2, make, [](const auto& v) {
+			const auto size = v.size();
+			for (std::size_t i = 0; i < size; ++i) {
+				static_cast<void>(v.at(i));
+			}
+		});
+		check_calls("operator std::string", calls, n, 2, make, [](const auto& v) {
+			static_cast<void>(static_cast<std::string>(v));
+		});
+		check_calls("operator<<", calls, n, 1, make, [](const auto& v) {
+			auto os = std::ostringstream{};
+			os << v;
+		});
+		// both sides count, so these are bounded per byte of either
+		check_calls("operator==", calls, 2 * n, 1, make, [&make](const auto& v) { CHECK(v == make()); });
+		check_calls("operator<=>", calls, 2 * n, 1, make, [&make](const auto& v) {
+			CHECK(std::is_eq(v <=> make()));
+		});
+		check_calls("split()", calls, n, 2, make, [](const auto& v) {
+			static_cast<void>(fsv::split(v, fsv::filtered_string_view{"a"}));
+		});
+		check_calls("substr()", calls, n, 3, make, [](const auto& v) {
+			static_cast<void>(fsv::substr(v, v.size() / 4, v.size() / 2));
+		});
+	}
+} // namespace
+
+TEST_CASE("operations on a type-erased view call the predicate O(n) times") {
+	constexpr std::size_t n = 4096;
+	auto calls = std::size_t{0};
+	for (const auto& [name, text] : shapes(n)) {
+		INFO(name);
+		check_operations(calls, n, [&text = text, &calls] {
+			const auto pred = fsv::filter{counting_predicate{not_space, calls}};
+			return fsv::filtered_string_view{text.data(), text.data() + text.size(), pred};
+		});
+	}
+}
+
+TEST_CASE("operations on a view with an inline predicate call it O(n) times") {
+	constexpr std::size_t n = 4096;
+	auto calls = std::size_t{0};
+	for (const auto& [name, text] : shapes(n)) {
+		INFO(name);
+		check_operations(calls, n, [&text = text, &calls] {
+			const auto pred = counting_predicate{not_space, calls};
+			return fsv::basic_filtered_string_view{text.data(), text.data() + text.size(), pred};
+		});
+	}
+}
@@ -0,0 +1,100 @@
+#include "./fd_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace fsv::detail {
+	namespace {
+		auto iov_max() noexcept -> std::size_t {
+#if defined(IOV_MAX)
+			return IOV_MAX;
+#else
+			const auto soln = sysconf(_SC_IOV_MAX);
+			return soln > 0 ? static_cast<std::size_t>(soln) : 16;
+#endif
+		}
+	} // namespace
+
+	fd_writer::fd_writer(int fd)
+	: fd_{fd}
+	, batch_{iov_max()}
+	, staging_(staging_size) {
+		iov_.reserve(batch_);
+	}
+
+	void fd_writer::append(const char* ptr, std::size_t length) {
+		if (length >= small_span) {
+			for (; length > 0;) {
+				const auto n = std::min(length, max_span);
+				push(ptr, n);
+				ptr += n;
+				length -= n;
+			}
+			return;
+		}
+		if (length == 0) {
+			return;
+		}
+		if (staged_ + length > staging_.size()) {
+			flush();
+		}
+		char* dest = staging_.data() + staged_;
+		std::memcpy(dest, ptr, length);
+		staged_ += length;
+		// extend the previous iovec when it ends where this span was staged
+		if (not iov_.empty() and static_cast<char*>(iov_.back().iov_base) + iov_.back().iov_len == dest) {
+			iov_.back().iov_len += length;
+			return;
+		}
+		push(dest, length);
+	}
+
+	void fd_writer::push(const char* ptr, std::size_t length) {
+		// writev does not write through iov_base, the cast only satisfies its declaration
+		iov_.push_back(iovec{const_cast<char*>(ptr), length});
+		if (iov_.size() == batch_) {
+			flush();
+		}
+	}
+
+	void fd_writer::flush() {
+		auto* first = iov_.data();
+		auto* last = iov_.data() + iov_.size();
+		while (first != last) {
+			const auto count = static_cast<int>(std::min(static_cast<std::size_t>(last - first), batch_));
+			const auto n = ::writev(fd_, first, count);
+			// Every pending iovec holds bytes, so writing none of them means writev cannot make progress, and
+			// retrying would spin; it is reported as an I/O error.
+			if (n <= 0) {
+				const auto error = n < 0 ? errno : EIO;
+				if (error == EINTR) {
+					continue;
+				}
+				iov_.clear();
+				staged_ = 0;
+				throw std::system_error{error, std::generic_category(), "filtered_string_view::write_to_fd"};
+			}
+			// skip what was written, which may end part way through an iovec
+			auto done = static_cast<std::size_t>(n);
+			written_ += done;
+			for (; first != last and done >= first->iov_len; ++first) {
+				done -= first->iov_len;
+			}
+			if (first != last) {
+				first->iov_base = static_cast<char*>(first->iov_base) + done;
+				first->iov_len -= done;
+			}
+		}
+		iov_.clear();
+		staged_ = 0;
+	}
+
+	auto fd_writer::written() const noexcept -> std::size_t {
+		return written_;
+	}
+} // namespace fsv::detail
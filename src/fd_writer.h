@@ -0,0 +1,39 @@
+#ifndef COMP6771_ASS2_FD_WRITER_H
+#define COMP6771_ASS2_FD_WRITER_H
+
+#include <cstddef>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace fsv::detail {
+	// Gathers spans of memory into batches of iovecs and hands each batch to writev. Spans shorter than
+	// small_span are copied into a staging buffer instead, where neighbours coalesce into one iovec, so that many
+	// tiny runs do not each cost an iovec. Throws std::system_error if a write fails.
+	class fd_writer {
+	 public:
+		static constexpr std::size_t small_span = 256;
+		static constexpr std::size_t staging_size = 64 * 1024;
+		// keeps the total of a batch well inside ssize_t
+		static constexpr std::size_t max_span = std::size_t{1} << 30;
+
+		explicit fd_writer(int fd);
+
+		// the bytes must stay valid until the next flush()
+		void append(const char* ptr, std::size_t length);
+		void flush();
+		[[nodiscard]] auto written() const noexcept -> std::size_t;
+
+	 private:
+		void push(const char* ptr, std::size_t length);
+
+		int fd_;
+		std::size_t batch_;
+		std::vector<iovec> iov_;
+		std::vector<char> staging_;
+		std::size_t staged_ = 0;
+		std::size_t written_ = 0;
+	};
+} // namespace fsv::detail
+
+#endif // COMP6771_ASS2_FD_WRITER_H
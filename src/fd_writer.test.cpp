@@ -0,0 +1,75 @@
+#include "./fd_writer.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <string>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace {
+	// an unlinked temporary file, read back from the start
+	class temp_file {
+	 public:
+		temp_file()
+		: file_{std::tmpfile()} {}
+		temp_file(const temp_file&) = delete;
+		auto operator=(const temp_file&) -> temp_file& = delete;
+		~temp_file() {
+			std::fclose(file_);
+		}
+
+		[[nodiscard]] auto fd() const -> int {
+			return fileno(file_);
+		}
+
+		[[nodiscard]] auto contents() const -> std::string {
+			auto soln = std::string(static_cast<std::size_t>(::lseek(fd(), 0, SEEK_END)), '\0');
+			REQUIRE(::pread(fd(), soln.data(), soln.size(), 0) == static_cast<ssize_t>(soln.size()));
+			return soln;
+		}
+
+	 private:
+		std::FILE* file_;
+	};
+} // namespace
+
+TEST_CASE("fd_writer writes spans in order") {
+	auto file = temp_file{};
+	auto out = fsv::detail::fd_writer{file.fd()};
+	const auto big = std::string(1000, 'b');
+	out.append("small ", 6);
+	out.append(big.data(), big.size());
+	out.append("", 0);
+	out.append(" end", 4);
+	out.flush();
+	CHECK(out.written() == 1010);
+	CHECK(file.contents() == "small " + big + " end");
+}
+
+TEST_CASE("fd_writer batches more spans than one writev takes") {
+	auto file = temp_file{};
+	auto out = fsv::detail::fd_writer{file.fd()};
+	auto source = std::string{};
+	for (int i = 0; i < 3000; ++i) {
+		source += std::string(fsv::detail::fd_writer::small_span, static_cast<char>('a' + i % 26));
+	}
+	auto expected = std::string{};
+	// large spans each take an iovec, and the short ones in between are staged
+	for (std::size_t i = 0; i < source.size(); i += fsv::detail::fd_writer::small_span) {
+		out.append(source.data() + i, fsv::detail::fd_writer::small_span);
+		out.append(source.data() + i, 3);
+		expected.append(source, i, fsv::detail::fd_writer::small_span);
+		expected.append(source, i, 3);
+	}
+	out.flush();
+	CHECK(out.written() == expected.size());
+	CHECK(file.contents() == expected);
+}
+
+TEST_CASE("fd_writer reports write errors") {
+	auto out = fsv::detail::fd_writer{-1};
+	out.append("lost", 4);
+	REQUIRE_THROWS_AS(out.flush(), std::system_error);
+}
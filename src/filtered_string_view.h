@@ -1,24 +1,56 @@
 #ifndef COMP6771_ASS2_FSV_H
 #define COMP6771_ASS2_FSV_H
 
+#include "./char_class.h"
+#include "./fd_writer.h"
+#include "./inline_filter.h"
+#include "./predicates.h"
+#include "./rank_select.h"
+#include "./scan_kernels.h"
+#include "./string_search.h"
+
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <compare>
+#include <concepts>
 #include <cstring>
 #include <functional>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <ostream>
+#include <ranges>
 #include <set>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace fsv {
-	using filter = std::function<bool(const char&)>;
-	class filtered_string_view {
+	template<typename Pred>
+	class split_view;
+
+	// how compose() orders filters that are not char_class tables
+	enum class compose_order {
+		// as given
+		given,
+		// by cost per rejection, measured on the first block of the view's buffer
+		adaptive,
+	};
+
+	// A view whose predicate is stored by value with its concrete type, so that the per-character calls in the loops
+	// below can be inlined. filtered_string_view is the type-erased instantiation over fsv::filter.
+	template<typename Pred = filter>
+	class basic_filtered_string_view {
+		static_assert(std::predicate<const Pred&, const char&>, "Pred must be callable as bool(const char&)");
+
 		class iter {
-			friend filtered_string_view;
+			friend basic_filtered_string_view;
 
 		 public:
 			using MEMBER_TYPEDEFS_GO_HERE = void;
@@ -29,7 +61,7 @@ namespace fsv {
 			using pointer = void;
 			using difference_type = std::ptrdiff_t;
 
-			iter() noexcept;
+			iter() noexcept = default;
 
 			[[nodiscard]] auto operator*() const -> reference;
 			auto operator->() const -> pointer;
@@ -39,26 +71,209 @@ namespace fsv {
 			auto operator--() -> iter&;
 			auto operator--(int) -> iter;
 
-			friend auto operator==(const iter&, const iter&) -> bool;
-			friend auto operator!=(const iter&, const iter&) -> bool;
+			friend auto operator==(const iter& lhs, const iter& rhs) -> bool {
+				return ((lhs.iterator_ptr_ == rhs.iterator_ptr_) and (lhs.fsv_ == rhs.fsv_));
+			}
+			friend auto operator!=(const iter& lhs, const iter& rhs) -> bool {
+				return !(lhs == rhs);
+			}
 
 		 private:
-			iter(const char* iterator_ptr, const filtered_string_view* fsv, const int index) noexcept
+			iter(const char* iterator_ptr, const basic_filtered_string_view* fsv) noexcept
 			: iterator_ptr_{iterator_ptr}
-			, fsv_{fsv}
-			, index_{index} {}
+			, fsv_{fsv} {}
+
+			// an accepted byte of the view, or the end of its buffer, which is where end() points
+			const char* iterator_ptr_ = nullptr;
+			const basic_filtered_string_view* fsv_ = nullptr;
+		};
+
+		// Random-access iterator over the same characters, addressed by filtered index and resolved through the
+		// rank/select index, so that jumps and distances are constant time instead of a walk over the bytes between.
+		// Unfiltered views have no index, and their filtered index is the raw position.
+		class indexed_iter {
+			friend basic_filtered_string_view;
+
+		 public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = char;
+			using reference = const char&;
+			using pointer = const char*;
+			using difference_type = std::ptrdiff_t;
+
+			indexed_iter() noexcept = default;
+
+			[[nodiscard]] auto operator*() const -> reference {
+				return ptr_[index_ == nullptr ? pos_ : index_->select(pos_)];
+			}
+			[[nodiscard]] auto operator[](difference_type n) const -> reference {
+				return *(*this + n);
+			}
+
+			auto operator++() -> indexed_iter& {
+				++pos_;
+				return *this;
+			}
+			auto operator++(int) -> indexed_iter {
+				auto save = *this;
+				++pos_;
+				return save;
+			}
+			auto operator--() -> indexed_iter& {
+				--pos_;
+				return *this;
+			}
+			auto operator--(int) -> indexed_iter {
+				auto save = *this;
+				--pos_;
+				return save;
+			}
+			auto operator+=(difference_type n) -> indexed_iter& {
+				pos_ = static_cast<std::size_t>(static_cast<difference_type>(pos_) + n);
+				return *this;
+			}
+			auto operator-=(difference_type n) -> indexed_iter& {
+				return *this += -n;
+			}
+
+			friend auto operator+(indexed_iter it, difference_type n) -> indexed_iter {
+				return it += n;
+			}
+			friend auto operator+(difference_type n, indexed_iter it) -> indexed_iter {
+				return it += n;
+			}
+			friend auto operator-(indexed_iter it, difference_type n) -> indexed_iter {
+				return it -= n;
+			}
+			friend auto operator-(const indexed_iter& lhs, const indexed_iter& rhs) -> difference_type {
+				return static_cast<difference_type>(lhs.pos_) - static_cast<difference_type>(rhs.pos_);
+			}
+			friend auto operator==(const indexed_iter& lhs, const indexed_iter& rhs) -> bool {
+				return lhs.pos_ == rhs.pos_ and lhs.index_ == rhs.index_;
+			}
+			friend auto operator<=>(const indexed_iter& lhs, const indexed_iter& rhs) -> std::strong_ordering {
+				return lhs.pos_ <=> rhs.pos_;
+			}
+
+		 private:
+			indexed_iter(const char* ptr, const detail::rank_select* index, std::size_t pos) noexcept
+			: ptr_{ptr}
+			, index_{index}
+			, pos_{pos} {}
+
+			const char* ptr_ = nullptr;
+			// nullptr when the view is unfiltered
+			const detail::rank_select* index_ = nullptr;
+			// filtered index of the character
+			std::size_t pos_ = 0;
+		};
+
+		// Forward iterator over the maximal runs of consecutive accepted bytes, each a view of the underlying string.
+		class run_iter {
+			friend basic_filtered_string_view;
+
+		 public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::string_view;
+			using reference = const std::string_view&;
+			using pointer = const std::string_view*;
+			using difference_type = std::ptrdiff_t;
+
+			run_iter() noexcept = default;
+
+			[[nodiscard]] auto operator*() const noexcept -> reference {
+				return run_;
+			}
+			auto operator->() const noexcept -> pointer {
+				return &run_;
+			}
+
+			auto operator++() -> run_iter& {
+				// the byte after a run is either the end of the buffer or known to be rejected
+				const char* last = run_.data() + run_.size();
+				run_ = fsv_->find_run(last == fsv_->ptr_ + fsv_->length_ ? last : last + 1, table_, scanner_);
+				return *this;
+			}
+			auto operator++(int) -> run_iter {
+				auto save = *this;
+				++(*this);
+				return save;
+			}
+
+			friend auto operator==(const run_iter& lhs, const run_iter& rhs) noexcept -> bool {
+				return lhs.run_.data() == rhs.run_.data();
+			}
+			friend auto operator==(const run_iter& it, std::default_sentinel_t) noexcept -> bool {
+				return it.run_.empty();
+			}
+
+		 private:
+			explicit run_iter(const basic_filtered_string_view* fsv)
+			: fsv_{fsv}
+			, table_{detail::table_of(fsv->predicate_)}
+			, run_{fsv->find_run(fsv->ptr_, table_, scanner_)} {}
+
+			const basic_filtered_string_view* fsv_ = nullptr;
+			// the char_class behind the predicate, if there is one, looked up once rather than once a run
+			const char_class* table_ = nullptr;
+			// when there is a table, the classified bytes and run boundaries past the current run, which the next
+			// run is taken from
+			detail::run_scanner scanner_;
+			// empty once past the last run
+			std::string_view run_;
+		};
 
-			const char* iterator_ptr_;
-			const filtered_string_view* fsv_;
-			int index_;
+		// The characters of a view a stretch at a time, for compare_runs. A view over a char_class compacts a block
+		// of its buffer per stretch, so that short runs cost a pass of the compaction kernel instead of one step of
+		// the run scanner each; other views hand out their runs.
+		class stretch_reader {
+		 public:
+			explicit stretch_reader(const basic_filtered_string_view& fsv) noexcept
+			: fsv_{&fsv}
+			, table_{fsv.accepts_all() ? nullptr : detail::table_of(fsv.predicate_)} {}
+
+			// the next stretch, or an empty one once the view is exhausted
+			auto next() -> std::string_view {
+				if (table_ != nullptr) {
+					while (offset_ < fsv_->length_) {
+						const std::size_t in = std::min(block, fsv_->length_ - offset_);
+						const std::size_t out =
+						    detail::compact_accepted(fsv_->ptr_ + offset_, in, *table_, buffer_.data(), block);
+						offset_ += in;
+						if (out != 0) {
+							return {buffer_.data(), out};
+						}
+					}
+					return {};
+				}
+				if (not runs_) {
+					runs_ = run_iter{fsv_};
+					return **runs_;
+				}
+				return *++*runs_;
+			}
+
+		 private:
+			static constexpr std::size_t block = 4096;
+
+			const basic_filtered_string_view* fsv_;
+			const char_class* table_;
+			// with a table, how much of the buffer has been compacted
+			std::size_t offset_ = 0;
+			std::array<char, block> buffer_;
+			// without one, the current run, started by the first next()
+			std::optional<run_iter> runs_;
 		};
 
 	 public:
+		using predicate_type = Pred;
 		static filter default_predicate;
 		using iterator = iter;
 		using const_iterator = iter;
 		using reverse_iterator = std::reverse_iterator<iter>;
 		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using indexed_iterator = indexed_iter;
+		using run_iterator = run_iter;
 
 		// range
 		[[nodiscard]] auto begin() const noexcept -> iterator;
@@ -71,49 +286,876 @@ namespace fsv {
 		[[nodiscard]] auto rend() const noexcept -> reverse_iterator;
 		[[nodiscard]] auto crend() const noexcept -> const_reverse_iterator;
 
+		// the characters again, as a random-access range; builds the position index if the view is filtered and it
+		// has not been built yet
+		[[nodiscard]] auto indexed() const -> std::ranges::subrange<indexed_iterator>;
+
+		// The maximal runs of consecutive accepted bytes, in order. Concatenated, they are the view's characters. Run
+		// boundaries in char_class views are found in bitmaps from the SIMD kernels, each byte classified once.
+		[[nodiscard]] auto runs() const -> std::ranges::subrange<run_iterator, std::default_sentinel_t>;
+		// calls f with each run in turn, as a std::string_view
+		template<typename F>
+		void for_each_run(F&& f) const;
+
 		// constructors
-		explicit filtered_string_view() noexcept;
-		filtered_string_view(const std::string& str) noexcept;
-		explicit filtered_string_view(const std::string& str, filter predicate) noexcept;
-		filtered_string_view(const char* str) noexcept;
-		explicit filtered_string_view(const char* str, filter predicate) noexcept;
+		explicit basic_filtered_string_view() noexcept
+		requires std::constructible_from<Pred, const accept_all&>;
+		basic_filtered_string_view(const std::string& str) noexcept
+		requires std::constructible_from<Pred, const accept_all&>;
+		explicit basic_filtered_string_view(const std::string& str, Pred predicate) noexcept;
+		basic_filtered_string_view(const char* str) noexcept
+		requires std::constructible_from<Pred, const accept_all&>;
+		explicit basic_filtered_string_view(const char* str, Pred predicate) noexcept;
+		// views the bytes in [first, last), which need not be null-terminated
+		basic_filtered_string_view(const char* first, const char* last) noexcept
+		requires std::constructible_from<Pred, const accept_all&>;
+		explicit basic_filtered_string_view(const char* first, const char* last, Pred predicate) noexcept;
 
-		filtered_string_view(const filtered_string_view& other) noexcept;
-		filtered_string_view(filtered_string_view&& other) noexcept;
+		basic_filtered_string_view(const basic_filtered_string_view& other) noexcept;
+		basic_filtered_string_view(basic_filtered_string_view&& other) noexcept;
 
 		// destructor
-		~filtered_string_view() noexcept;
+		~basic_filtered_string_view() noexcept = default;
 
 		// member operators
-		auto operator=(const filtered_string_view& other) noexcept -> filtered_string_view&;
-		auto operator=(filtered_string_view&& other) noexcept -> filtered_string_view&;
-		[[nodiscard]] auto operator[](int n) const -> const char&;
+		auto operator=(const basic_filtered_string_view& other) noexcept -> basic_filtered_string_view&;
+		auto operator=(basic_filtered_string_view&& other) noexcept -> basic_filtered_string_view&;
+		[[nodiscard]] auto operator[](std::size_t n) const -> const char&;
+		template<std::signed_integral I>
+		[[nodiscard]] auto operator[](I n) const -> const char&;
 		[[nodiscard]] explicit operator std::string() const noexcept;
 
 		// member functions
 		[[nodiscard]] auto size() const noexcept -> std::size_t;
 		[[nodiscard]] auto data() const noexcept -> const char*;
-		[[nodiscard]] auto at(int index) const -> const char&;
+		[[nodiscard]] auto at(std::size_t index) const -> const char&;
+		// signed indices, int among them, for compatibility; negative ones are invalid
+		template<std::signed_integral I>
+		[[nodiscard]] auto at(I index) const -> const char&;
 		[[nodiscard]] auto empty() const noexcept -> bool;
-		[[nodiscard]] auto predicate() const noexcept -> const filter&;
+		[[nodiscard]] auto predicate() const noexcept -> const Pred&;
+		// Copies the characters, in order, to the front of out until it is full, and returns how many were copied.
+		// Nothing in out past that count is written.
+		auto copy_to(std::span<char> out) const -> std::size_t;
+		// Replaces the contents of out with the characters, reusing its capacity where it suffices.
+		void materialize_into(std::string& out) const;
+		// Writes the characters to a file descriptor with writev, a batch of runs per call, without materializing
+		// them first. Returns the number of bytes written; throws std::system_error if a write fails.
+		auto write_to_fd(int fd) const -> std::size_t;
 
 		// non-member operators
-		friend auto operator==(const filtered_string_view& lhs, const filtered_string_view& rhs) -> bool;
-		friend auto operator<<(std::ostream& os, const filtered_string_view& fsv) -> std::ostream&;
-		friend auto operator<=>(const filtered_string_view& lhs, const filtered_string_view& rhs) -> std::strong_ordering;
+		friend auto operator==(const basic_filtered_string_view& lhs, const basic_filtered_string_view& rhs) -> bool {
+			return equal(lhs, rhs);
+		}
+		friend auto operator<<(std::ostream& os, const basic_filtered_string_view& fsv) -> std::ostream& {
+			return print(os, fsv);
+		}
+		friend auto operator<=>(const basic_filtered_string_view& lhs, const basic_filtered_string_view& rhs)
+		    -> std::strong_ordering {
+			return compare(lhs, rhs);
+		}
 
 	 private:
+		template<typename>
+		friend class split_view;
+		// rebuilds the view over its own bounds, which data() alone does not give
+		friend auto compose(const basic_filtered_string_view<filter>& fsv,
+		                    const std::vector<filter>& filts,
+		                    compose_order order) -> basic_filtered_string_view<filter>;
+
+		[[nodiscard]] static auto equal(const basic_filtered_string_view& lhs, const basic_filtered_string_view& rhs)
+		    -> bool;
+		[[nodiscard]] static auto compare(const basic_filtered_string_view& lhs, const basic_filtered_string_view& rhs)
+		    -> std::strong_ordering;
+		static auto print(std::ostream& os, const basic_filtered_string_view& fsv) -> std::ostream&;
+		template<typename Cmp>
+		[[nodiscard]] static auto compare_runs(const basic_filtered_string_view& lhs,
+		                                       const basic_filtered_string_view& rhs,
+		                                       Cmp cmp) -> std::strong_ordering;
+
+		// calls f with the char_class behind the predicate when there is one, and with the predicate itself otherwise
+		template<typename F>
+		auto visit_predicate(F&& f) const -> decltype(auto);
+
+		// the first run that starts at or after pos, or an empty view at the end of the buffer; table is
+		// table_of(predicate_), and views that have one take their runs from scanner in order instead, which picks
+		// up after the run that ended before pos
+		[[nodiscard]] auto find_run(const char* pos, const char_class* table, detail::run_scanner& scanner) const
+		    -> std::string_view;
+
+		// whether the predicate is known to accept every byte, in which case the view is exactly its raw bytes
+		[[nodiscard]] auto accepts_all() const noexcept -> bool;
+		[[nodiscard]] static auto is_unfiltered(const Pred& predicate) noexcept -> bool;
+
+		// the first accepted byte at or after pos, or the end of the buffer if there is none
+		[[nodiscard]] auto next_accepted(const char* pos) const -> const char*;
+		// the last accepted byte before pos, or pos if there is none
+		[[nodiscard]] auto prev_accepted(const char* pos) const -> const char*;
+
+		// builds the rank/select index over the accepted positions on first use
+		[[nodiscard]] auto index() const -> const detail::rank_select&;
+
 		const char* ptr_;
 		std::size_t length_;
-		filter predicate_;
+		Pred predicate_;
+		// is_unfiltered(predicate_), worked out once so that the fast paths cost a flag test
+		bool unfiltered_;
+		// the value of size_ before the accepted bytes have been counted
+		static constexpr std::size_t unknown_size = static_cast<std::size_t>(-1);
+
+		// The caches below are filled in by const members and published atomically, so that one view can be read
+		// from several threads at once like any other const object.
+		// number of accepted bytes, computed by the first call to size()
+		mutable std::atomic<std::size_t> size_ = unknown_size;
+		// lazily built by at() and shared between copies, which always view the same bytes through the same predicate
+		detail::index_cache index_;
 	};
 
+	using filtered_string_view = basic_filtered_string_view<filter>;
+
 	// non-member utility functions
-	[[nodiscard]] auto compose(const filtered_string_view& fsv, const std::vector<filter>& filts) -> filtered_string_view;
+	[[nodiscard]] auto compose(const filtered_string_view& fsv,
+	                           const std::vector<filter>& filts,
+	                           compose_order order = compose_order::given) -> filtered_string_view;
+	// pos and count may be any integer type; a count of zero or less means the rest of the view
+	template<typename Pred, std::integral Pos = int, std::integral Count = int>
+	[[nodiscard]] auto substr(const basic_filtered_string_view<Pred>& fsv, Pos pos = 0, Count count = 0)
+	    -> basic_filtered_string_view<Pred>;
+	// lets a string or string literal convert to a view, which the template above cannot deduce through
 	[[nodiscard]] auto substr(const filtered_string_view& fsv, int pos = 0, int count = 0) -> filtered_string_view;
+	template<typename Pred, typename TokPred>
+	[[nodiscard]] auto
+	split(const basic_filtered_string_view<Pred>& fsv, const basic_filtered_string_view<TokPred>& tok)
+	    -> std::vector<basic_filtered_string_view<Pred>>;
 	[[nodiscard]] auto split(const filtered_string_view& fsv, const filtered_string_view& tok)
 	    -> std::vector<filtered_string_view>;
 
+	template<typename Pred>
+	filter basic_filtered_string_view<Pred>::default_predicate = accept_all{};
+
+	// default constructor
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view() noexcept
+	requires std::constructible_from<Pred, const accept_all&>
+	: ptr_{nullptr}
+	, length_{0}
+	, predicate_{detail::accept_everything}
+	, unfiltered_{is_unfiltered(predicate_)} {}
+
+	// implicit string constructor
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view(const std::string& str) noexcept
+	requires std::constructible_from<Pred, const accept_all&>
+	: ptr_{str.data()}
+	, length_{str.length()}
+	, predicate_{detail::accept_everything}
+	, unfiltered_{is_unfiltered(predicate_)} {}
+
+	// string constructor with predicate
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view(const std::string& str, Pred predicate) noexcept
+	: ptr_{str.data()}
+	, length_{str.length()}
+	, predicate_{std::move(predicate)}
+	, unfiltered_{is_unfiltered(predicate_)} {}
+
+	// implicit null terminated sting constructor
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view(const char* str) noexcept
+	requires std::constructible_from<Pred, const accept_all&>
+	: ptr_{str}
+	, length_{std::strlen(str)}
+	, predicate_{detail::accept_everything}
+	, unfiltered_{is_unfiltered(predicate_)} {}
+
+	// null terminated string constructor with predicate
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view(const char* str, Pred predicate) noexcept
+	: ptr_{str}
+	, length_{std::strlen(str)}
+	, predicate_{std::move(predicate)}
+	, unfiltered_{is_unfiltered(predicate_)} {}
+
+	// bounded constructors
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view(const char* first, const char* last) noexcept
+	requires std::constructible_from<Pred, const accept_all&>
+	: ptr_{first}
+	, length_{static_cast<std::size_t>(last - first)}
+	, predicate_{detail::accept_everything}
+	, unfiltered_{is_unfiltered(predicate_)} {}
+
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view(const char* first,
+	                                                             const char* last,
+	                                                             Pred predicate) noexcept
+	: ptr_{first}
+	, length_{static_cast<std::size_t>(last - first)}
+	, predicate_{std::move(predicate)}
+	, unfiltered_{is_unfiltered(predicate_)} {}
+
+	// copy constructor
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view(const basic_filtered_string_view& other) noexcept
+	: ptr_{other.ptr_}
+	, length_{other.length_}
+	, predicate_{other.predicate_}
+	, unfiltered_{other.unfiltered_}
+	, size_{other.size_.load(std::memory_order_relaxed)}
+	, index_{other.index_} {}
+
+	// move constructor
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::basic_filtered_string_view(basic_filtered_string_view&& other) noexcept
+	: ptr_{other.ptr_}
+	, length_{other.length_}
+	, predicate_{std::move(other.predicate_)}
+	, unfiltered_{other.unfiltered_}
+	, size_{other.size_.exchange(0, std::memory_order_relaxed)}
+	, index_{std::move(other.index_)} {
+		other.ptr_ = nullptr;
+		other.length_ = 0;
+		if constexpr (std::is_assignable_v<Pred&, const accept_all&>) {
+			other.predicate_ = detail::accept_everything;
+			other.unfiltered_ = is_unfiltered(other.predicate_);
+		}
+	}
+
+	// member operators
+	// copy assignment
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::operator=(const basic_filtered_string_view& other) noexcept
+	    -> basic_filtered_string_view& {
+		if (this != &other) {
+			ptr_ = other.ptr_;
+			length_ = other.length_;
+			predicate_ = other.predicate_;
+			unfiltered_ = other.unfiltered_;
+			size_.store(other.size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			index_ = other.index_;
+		}
+		return *this;
+	}
+
+	// move assignment
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::operator=(basic_filtered_string_view&& other) noexcept
+	    -> basic_filtered_string_view& {
+		if (this != &other) {
+			ptr_ = std::exchange(other.ptr_, nullptr);
+			length_ = std::exchange(other.length_, 0);
+			if constexpr (std::is_assignable_v<Pred&, const accept_all&>) {
+				predicate_ = std::exchange(other.predicate_, detail::accept_everything);
+			}
+			else {
+				predicate_ = std::move(other.predicate_);
+			}
+			unfiltered_ = std::exchange(other.unfiltered_, is_unfiltered(other.predicate_));
+			size_.store(other.size_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+			index_ = std::move(other.index_);
+		}
+		return *this;
+	}
+
+	// subscript
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::operator[](std::size_t n) const -> const char& {
+		return basic_filtered_string_view::at(n);
+	}
+
+	template<typename Pred>
+	template<std::signed_integral I>
+	auto basic_filtered_string_view<Pred>::operator[](I n) const -> const char& {
+		return basic_filtered_string_view::at(n);
+	}
+
+	// string type conversion
+	template<typename Pred>
+	basic_filtered_string_view<Pred>::operator std::string() const noexcept {
+		if (unfiltered_) {
+			return ptr_ == nullptr ? std::string() : std::string(ptr_, length_);
+		}
+		const std::size_t sz = basic_filtered_string_view::size();
+		if (sz == 0) {
+			return std::string();
+		}
+		auto soln = std::string(sz, '\0');
+		basic_filtered_string_view::copy_to(soln);
+		return soln;
+	}
+
+	// member functions
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::size() const noexcept -> std::size_t {
+		if (ptr_ == nullptr) {
+			return static_cast<std::size_t>(0);
+		}
+		if (accepts_all()) {
+			return length_;
+		}
+		auto soln = size_.load(std::memory_order_relaxed);
+		if (soln == unknown_size) {
+			soln = visit_predicate([this](const auto& pred) { return detail::count_accepted(ptr_, length_, pred); });
+			size_.store(soln, std::memory_order_relaxed);
+		}
+		return soln;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::copy_to(std::span<char> out) const -> std::size_t {
+		if (ptr_ == nullptr or out.empty()) {
+			return 0;
+		}
+		if (accepts_all()) {
+			const std::size_t n = std::min(length_, out.size());
+			std::memcpy(out.data(), ptr_, n);
+			return n;
+		}
+		return visit_predicate([&](const auto& pred) {
+			return detail::compact_accepted(ptr_, length_, pred, out.data(), out.size());
+		});
+	}
+
+	template<typename Pred>
+	void basic_filtered_string_view<Pred>::materialize_into(std::string& out) const {
+		// When out can already hold every raw byte, compacting into that and trimming saves the counting pass that
+		// an opaque predicate would otherwise need to size it exactly.
+		if (size_.load(std::memory_order_relaxed) == unknown_size and out.capacity() >= length_
+		    and detail::table_of(predicate_) == nullptr) {
+			out.resize(length_);
+			out.resize(basic_filtered_string_view::copy_to(out));
+			return;
+		}
+		out.resize(basic_filtered_string_view::size());
+		basic_filtered_string_view::copy_to(out);
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::write_to_fd(int fd) const -> std::size_t {
+		auto out = detail::fd_writer{fd};
+		if (ptr_ != nullptr) {
+			for_each_run([&out](std::string_view run) { out.append(run.data(), run.size()); });
+		}
+		out.flush();
+		return out.written();
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::data() const noexcept -> const char* {
+		return ptr_;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::at(std::size_t index) const -> const char& {
+		if (index >= length_) {
+			throw std::domain_error{"filtered_string_view::at(" + std::to_string(index) + "): invalid index"};
+		}
+		if (accepts_all()) {
+			return ptr_[index];
+		}
+		const auto& idx = basic_filtered_string_view::index();
+		if (index >= idx.count()) {
+			throw std::domain_error{"filtered_string_view::at(" + std::to_string(index) + "): invalid index"};
+		}
+		return ptr_[idx.select(index)];
+	}
+
+	template<typename Pred>
+	template<std::signed_integral I>
+	auto basic_filtered_string_view<Pred>::at(I index) const -> const char& {
+		if (index < 0) {
+			throw std::domain_error{"filtered_string_view::at(" + std::to_string(index) + "): invalid index"};
+		}
+		return basic_filtered_string_view::at(static_cast<std::size_t>(index));
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::index() const -> const detail::rank_select& {
+		if (const auto* idx = index_.get(); idx != nullptr) {
+			return *idx;
+		}
+		const auto& idx = index_.publish(
+		    visit_predicate([this](const auto& pred) { return detail::rank_select{ptr_, length_, pred}; }));
+		size_.store(idx.count(), std::memory_order_relaxed);
+		return idx;
+	}
+
+	template<typename Pred>
+	template<typename F>
+	auto basic_filtered_string_view<Pred>::visit_predicate(F&& f) const -> decltype(auto) {
+		if (const auto* table = detail::table_of(predicate_); table != nullptr) {
+			return std::forward<F>(f)(*table);
+		}
+		return std::forward<F>(f)(predicate_);
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::next_accepted(const char* pos) const -> const char* {
+		const char* last = ptr_ + length_;
+		return visit_predicate([&](const auto& pred) {
+			while (pos != last and not pred(*pos)) {
+				++pos;
+			}
+			return pos;
+		});
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::prev_accepted(const char* pos) const -> const char* {
+		return visit_predicate([&](const auto& pred) {
+			for (const char* it = pos; it != ptr_;) {
+				if (pred(*--it)) {
+					return it;
+				}
+			}
+			return pos;
+		});
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::find_run(const char* pos,
+	                                                const char_class* table,
+	                                                detail::run_scanner& scanner) const -> std::string_view {
+		if (accepts_all()) {
+			return std::string_view{pos, static_cast<std::size_t>(ptr_ + length_ - pos)};
+		}
+		if (table != nullptr) {
+			const auto [first, last] = scanner.next(ptr_, length_, *table);
+			return std::string_view{ptr_ + first, last - first};
+		}
+		const auto from = static_cast<std::size_t>(pos - ptr_);
+		const auto first = detail::find_accepted(ptr_, from, length_, predicate_, true);
+		const auto last = first == length_ ? first : detail::find_accepted(ptr_, first + 1, length_, predicate_, false);
+		return std::string_view{ptr_ + first, last - first};
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::accepts_all() const noexcept -> bool {
+		return unfiltered_;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::is_unfiltered(const Pred& predicate) noexcept -> bool {
+		if (detail::is_accept_all(predicate)) {
+			return true;
+		}
+		const auto* table = detail::table_of(predicate);
+		return table != nullptr and *table == char_class::all();
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::empty() const noexcept -> bool {
+		return (basic_filtered_string_view::size() == 0) ? true : false;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::predicate() const noexcept -> const Pred& {
+		return predicate_;
+	}
+
+	// non-member operators
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::equal(const basic_filtered_string_view& lhs,
+	                                             const basic_filtered_string_view& rhs) -> bool {
+		if (lhs.unfiltered_ and rhs.unfiltered_) {
+			return lhs.size() == rhs.size()
+			       and (lhs.size() == 0 or std::memcmp(lhs.ptr_, rhs.ptr_, lhs.size()) == 0);
+		}
+		return std::is_eq(compare_runs(lhs, rhs, [](const char* l, const char* r, std::size_t n) {
+			return std::memcmp(l, r, n) == 0 ? std::strong_ordering::equal : std::strong_ordering::less;
+		}));
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::print(std::ostream& os, const basic_filtered_string_view& fsv)
+	    -> std::ostream& {
+		const auto sentry = std::ostream::sentry{os};
+		if (not sentry or fsv.ptr_ == nullptr) {
+			return os;
+		}
+		auto* buf = os.rdbuf();
+		auto write = [&os, buf](const char* ptr, std::size_t n) {
+			if (buf->sputn(ptr, static_cast<std::streamsize>(n)) != static_cast<std::streamsize>(n)) {
+				os.setstate(std::ios_base::badbit);
+			}
+			return static_cast<bool>(os);
+		};
+		if (fsv.accepts_all()) {
+			write(fsv.ptr_, fsv.length_);
+		}
+		else if (const auto* table = detail::table_of(fsv.predicate_); table != nullptr) {
+			// compact a block at a time into a local buffer and hand each block to the stream in one write
+			constexpr std::size_t block = 4096;
+			auto buffer = std::array<char, block>{};
+			for (std::size_t i = 0; i < fsv.length_; i += block) {
+				const std::size_t in = std::min(block, fsv.length_ - i);
+				const std::size_t out = detail::compact_accepted(fsv.ptr_ + i, in, *table, buffer.data(), block);
+				if (not write(buffer.data(), out)) {
+					break;
+				}
+			}
+		}
+		else {
+			for (const auto& run : fsv.runs()) {
+				if (not write(run.data(), run.size())) {
+					break;
+				}
+			}
+		}
+		os.width(0);
+		return os;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::compare(const basic_filtered_string_view& lhs,
+	                                               const basic_filtered_string_view& rhs) -> std::strong_ordering {
+		return compare_runs(lhs, rhs, [](const char* l, const char* r, std::size_t n) {
+			return detail::compare_chars(l, r, n);
+		});
+	}
+
+	// Walks the stretches of both views side by side and hands cmp each part where the current pair overlap, stopping
+	// at the first part that differs. Stretches are found only as they are reached, so neither view is sized first
+	// and nothing past the block holding the first difference is looked at.
+	template<typename Pred>
+	template<typename Cmp>
+	auto basic_filtered_string_view<Pred>::compare_runs(const basic_filtered_string_view& lhs,
+	                                                    const basic_filtered_string_view& rhs,
+	                                                    Cmp cmp) -> std::strong_ordering {
+		auto lhs_reader = stretch_reader{lhs};
+		auto rhs_reader = stretch_reader{rhs};
+		// the unmatched part of each side's current stretch, empty once that side has no more
+		auto lhs_run = lhs_reader.next();
+		auto rhs_run = rhs_reader.next();
+		while (not lhs_run.empty() and not rhs_run.empty()) {
+			const auto n = std::min(lhs_run.size(), rhs_run.size());
+			if (auto soln = cmp(lhs_run.data(), rhs_run.data(), n); std::is_neq(soln)) {
+				return soln;
+			}
+			lhs_run.remove_prefix(n);
+			rhs_run.remove_prefix(n);
+			if (lhs_run.empty()) {
+				lhs_run = lhs_reader.next();
+			}
+			if (rhs_run.empty()) {
+				rhs_run = rhs_reader.next();
+			}
+		}
+		// whichever side still has characters is the longer, and a proper prefix orders first
+		return not lhs_run.empty() <=> not rhs_run.empty();
+	}
+
+	// iterator
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::iter::operator*() const -> reference {
+		return *iterator_ptr_;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::iter::operator->() const -> void {}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::iter::operator++() -> iter& {
+		iterator_ptr_ = fsv_->next_accepted(iterator_ptr_ + 1);
+		return *this;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::iter::operator++(int) -> iter {
+		auto save = *this;
+		++(*this);
+		return save;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::iter::operator--() -> iter& {
+		iterator_ptr_ = fsv_->prev_accepted(iterator_ptr_);
+		return *this;
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::iter::operator--(int) -> iter {
+		auto save = *this;
+		--(*this);
+		return save;
+	}
+
+	// end() is the end of the buffer, so it costs nothing, and begin() only reads up to the first accepted byte
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::begin() const noexcept -> iterator {
+		return iterator(next_accepted(ptr_), this);
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::end() const noexcept -> iterator {
+		return iterator(ptr_ + length_, this);
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::cbegin() const noexcept -> const_iterator {
+		return begin();
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::cend() const noexcept -> const_iterator {
+		return end();
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::indexed() const -> std::ranges::subrange<indexed_iterator> {
+		if (ptr_ == nullptr) {
+			return {indexed_iterator{}, indexed_iterator{}};
+		}
+		if (accepts_all()) {
+			return {indexed_iterator{ptr_, nullptr, 0}, indexed_iterator{ptr_, nullptr, length_}};
+		}
+		const auto& idx = basic_filtered_string_view::index();
+		return {indexed_iterator{ptr_, &idx, 0}, indexed_iterator{ptr_, &idx, idx.count()}};
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::runs() const
+	    -> std::ranges::subrange<run_iterator, std::default_sentinel_t> {
+		if (ptr_ == nullptr) {
+			return {run_iterator{}, std::default_sentinel};
+		}
+		return {run_iterator{this}, std::default_sentinel};
+	}
+
+	template<typename Pred>
+	template<typename F>
+	void basic_filtered_string_view<Pred>::for_each_run(F&& f) const {
+		for (const auto& run : runs()) {
+			f(run);
+		}
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::rbegin() const noexcept -> reverse_iterator {
+		return reverse_iterator{end()};
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::rend() const noexcept -> reverse_iterator {
+		return reverse_iterator{begin()};
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::crbegin() const noexcept -> const_reverse_iterator {
+		return reverse_iterator{cend()};
+	}
+
+	template<typename Pred>
+	auto basic_filtered_string_view<Pred>::crend() const noexcept -> const_reverse_iterator {
+		return reverse_iterator{cbegin()};
+	}
+
+	// The substring is bounded by the raw positions of its first and last characters and filtered by the parent's
+	// own predicate, so nested substrings never stack predicates and nothing past the substring is read.
+	template<typename Pred, std::integral Pos, std::integral Count>
+	auto substr(const basic_filtered_string_view<Pred>& fsv, Pos pos, Count count) -> basic_filtered_string_view<Pred> {
+		const auto size = fsv.size();
+		if (std::cmp_less(pos, 0) or std::cmp_greater(pos, size)) {
+			// reported by at() as an invalid index; pos == size is a substring of length 0
+			(void)fsv.at(pos);
+		}
+		const auto first_index = static_cast<std::size_t>(pos);
+		const auto rcount = std::cmp_less_equal(count, 0) ? (size > first_index ? size - first_index : 0)
+		                                                  : static_cast<std::size_t>(count);
+		if (rcount == 0) {
+			return basic_filtered_string_view<Pred>{fsv.data(), fsv.data(), fsv.predicate()};
+		}
+		const char* first = &fsv.at(first_index);
+		const char* last = &fsv.at(first_index + rcount - 1);
+		return basic_filtered_string_view<Pred>{first, last + 1, fsv.predicate()};
+	}
+
+	// A lazy range over the tokens of a view between non-overlapping occurrences of a delimiter, in the order and with
+	// the contents split() returns them. Each step resumes the search where the previous delimiter ended, so iterating
+	// the whole range reads the buffer once: unfiltered views are searched in place with memchr or Two-Way, and
+	// filtered ones by feeding each accepted byte to a KMP matcher. Tokens view the raw bytes between delimiters
+	// through the same predicate, already knowing their size. If the delimiter never occurs, or is empty, the only
+	// token is the view itself.
+	template<typename Pred>
+	class split_view {
+	 public:
+		using token_type = basic_filtered_string_view<Pred>;
+
+		class iterator {
+			friend split_view;
+
+		 public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = token_type;
+			using reference = const token_type&;
+			using pointer = const token_type*;
+			using difference_type = std::ptrdiff_t;
+
+			iterator() noexcept = default;
+
+			[[nodiscard]] auto operator*() const -> reference {
+				return *token_;
+			}
+			auto operator->() const -> pointer {
+				return &*token_;
+			}
+
+			auto operator++() -> iterator& {
+				if (last_) {
+					done_ = true;
+					token_.reset();
+				}
+				else {
+					first_ = next_;
+					load();
+				}
+				return *this;
+			}
+			auto operator++(int) -> iterator {
+				auto save = *this;
+				++(*this);
+				return save;
+			}
+
+			friend auto operator==(const iterator& lhs, const iterator& rhs) noexcept -> bool {
+				return lhs.done_ == rhs.done_ and (lhs.done_ or lhs.first_ == rhs.first_);
+			}
+			friend auto operator==(const iterator& it, std::default_sentinel_t) noexcept -> bool {
+				return it.done_;
+			}
+
+		 private:
+			explicit iterator(const split_view* view)
+			: view_{view}
+			, done_{false} {
+				load();
+			}
+
+			// finds the delimiter ending the token that starts at first_
+			void load() {
+				const auto found = view_->find(first_);
+				if (not found.found and first_ == 0) {
+					token_.emplace(view_->fsv_);
+				}
+				else {
+					token_.emplace(view_->token(first_, found.first, found.accepted));
+				}
+				next_ = found.last;
+				last_ = not found.found;
+			}
+
+			const split_view* view_ = nullptr;
+			std::optional<token_type> token_;
+			// raw offsets of the current token and of the one after it
+			std::size_t first_ = 0;
+			std::size_t next_ = 0;
+			bool last_ = false;
+			bool done_ = true;
+		};
+
+		template<typename TokPred>
+		split_view(const token_type& fsv, const basic_filtered_string_view<TokPred>& tok)
+		: fsv_{fsv}
+		, delimiter_{static_cast<std::string>(tok)}
+		, searcher_{delimiter_}
+		, matcher_{delimiter_} {}
+
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator{this};
+		}
+		[[nodiscard]] auto end() const noexcept -> std::default_sentinel_t {
+			return std::default_sentinel;
+		}
+
+	 private:
+		struct match {
+			// raw offsets of the delimiter, or both the end of the buffer when there is none
+			std::size_t first;
+			std::size_t last;
+			// accepted bytes between the search start and the delimiter
+			std::size_t accepted;
+			bool found;
+		};
+
+		[[nodiscard]] auto find(std::size_t from) const -> match {
+			const char* ptr = fsv_.ptr_;
+			const std::size_t length = fsv_.length_;
+			const std::size_t m = delimiter_.size();
+			if (ptr == nullptr or m == 0) {
+				return {length, length, 0, false};
+			}
+			if (fsv_.accepts_all()) {
+				const auto hit = static_cast<std::size_t>(searcher_(ptr + from, ptr + length) - ptr);
+				return {hit, hit == length ? length : hit + m, hit - from, hit != length};
+			}
+			const auto* table = detail::table_of(fsv_.predicate_);
+			if (table != nullptr and m == 1 and table->contains(static_cast<unsigned char>(delimiter_[0]))) {
+				// every raw occurrence of an accepted byte is an occurrence in the view
+				const auto* hit = static_cast<const char*>(std::memchr(ptr + from, delimiter_[0], length - from));
+				const auto first = hit == nullptr ? length : static_cast<std::size_t>(hit - ptr);
+				const auto accepted = detail::count_accepted(ptr + from, first - from, *table);
+				return {first, hit == nullptr ? length : first + 1, accepted, hit != nullptr};
+			}
+			return fsv_.visit_predicate([&](const auto& pred) -> match {
+				std::size_t state = 0;
+				std::size_t accepted = 0;
+				for (std::size_t i = from; i < length; ++i) {
+					if (not pred(ptr[i])) {
+						continue;
+					}
+					++accepted;
+					state = matcher_.step(state, ptr[i]);
+					if (state == m) {
+						// walk back to the first accepted byte of the delimiter
+						auto first = i;
+						for (auto left = m - 1; left > 0;) {
+							--first;
+							left -= static_cast<std::size_t>(static_cast<bool>(pred(ptr[first])));
+						}
+						return {first, i + 1, accepted - m, true};
+					}
+				}
+				return {length, length, accepted, false};
+			});
+		}
+
+		[[nodiscard]] auto token(std::size_t first, std::size_t last, std::size_t accepted) const -> token_type {
+			if (accepted == 0) {
+				return token_type{fsv_.ptr_ + first, fsv_.ptr_ + first, fsv_.predicate_};
+			}
+			auto soln = token_type{fsv_.ptr_ + first, fsv_.ptr_ + last, fsv_.predicate_};
+			soln.size_.store(accepted, std::memory_order_relaxed);
+			return soln;
+		}
+
+		token_type fsv_;
+		std::string delimiter_;
+		detail::two_way_searcher searcher_;
+		detail::stream_matcher matcher_;
+	};
+
+	template<typename Pred, typename TokPred>
+	split_view(const basic_filtered_string_view<Pred>&, const basic_filtered_string_view<TokPred>&) -> split_view<Pred>;
+
+	template<typename Pred, typename TokPred>
+	auto split(const basic_filtered_string_view<Pred>& fsv, const basic_filtered_string_view<TokPred>& tok)
+	    -> std::vector<basic_filtered_string_view<Pred>> {
+		auto soln = std::vector<basic_filtered_string_view<Pred>>{};
+		for (const auto& token : split_view{fsv, tok}) {
+			soln.push_back(token);
+		}
+		return soln;
+	}
+
+	// the type-erased view is compiled once, in filtered_string_view.cpp
+	extern template class basic_filtered_string_view<filter>;
+	extern template auto substr(const filtered_string_view& fsv, int pos, int count) -> filtered_string_view;
+	extern template auto substr(const filtered_string_view& fsv, std::size_t pos, std::size_t count)
+	    -> filtered_string_view;
+	extern template auto split(const filtered_string_view& fsv, const filtered_string_view& tok)
+	    -> std::vector<filtered_string_view>;
+
 } // namespace fsv
 
 #endif // COMP6771_ASS2_FSV_H
@@ -2,6 +2,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <thread>
+
 TEST_CASE("Static Data Members") {
 	for (char c = std::numeric_limits<char>::min(); c != std::numeric_limits<char>::max(); c++) {
 		REQUIRE(fsv::filtered_string_view::default_predicate(c));
@@ -259,6 +261,14 @@ TEST_CASE("substr") {
 	REQUIRE(fsv::substr(sv, 5, 5) == "ian H");
 }
 
+TEST_CASE("substr converts strings and string literals to views") {
+	auto s = std::string{"hello"};
+	CHECK(static_cast<std::string>(fsv::substr(s, 1, 3)) == "ell");
+	CHECK(static_cast<std::string>(fsv::substr("abc", 1)) == "bc");
+	CHECK(static_cast<std::string>(fsv::substr(s)) == "hello");
+	STATIC_REQUIRE(std::is_same_v<decltype(fsv::substr(s, std::size_t{1})), fsv::filtered_string_view>);
+}
+
 TEST_CASE("substr with predicate") {
 	auto is_upper = [](const char& c) { return std::isupper(static_cast<unsigned char>(c)); };
 	auto sv = fsv::filtered_string_view{"Sled Dog", is_upper};
@@ -424,4 +434,675 @@ TEST_CASE("Iterator prefix and postfix") {
 	REQUIRE(*(--it1) == 'b');
 	REQUIRE(*(it1--) == 'b');
 	REQUIRE(*(it1) == 'e');
-}
\ No newline at end of file
+}
+TEST_CASE("at() on a long buffer") {
+	auto s = std::string(10000, 'a');
+	for (std::size_t i = 0; i < s.size(); i += 3) {
+		s[i] = 'b';
+	}
+	auto sv = fsv::filtered_string_view{s, [](const char& c) { return c == 'b'; }};
+	REQUIRE(sv.size() == 3334);
+	for (int i = 0; i < static_cast<int>(sv.size()); ++i) {
+		REQUIRE(&sv[i] == s.data() + 3 * i);
+	}
+	REQUIRE_THROWS_AS(sv.at(3334), std::domain_error);
+}
+
+TEST_CASE("size() evaluates the predicate once per view") {
+	auto calls = std::size_t{0};
+	auto sv = fsv::filtered_string_view{"alaskan malamute", [&calls](const char& c) {
+		                                    ++calls;
+		                                    return c != 'a';
+	                                    }};
+	REQUIRE(sv.size() == 11);
+	REQUIRE(calls == 16);
+	REQUIRE(sv.size() == 11);
+	REQUIRE(sv.empty() == false);
+
+	const auto copy = sv;
+	REQUIRE(copy.size() == 11);
+	const auto moved = std::move(sv);
+	REQUIRE(moved.size() == 11);
+	REQUIRE(calls == 16);
+
+	sv = fsv::filtered_string_view{"husky"};
+	REQUIRE(sv.size() == 5);
+}
+
+TEST_CASE("const members may be called from several threads at once") {
+	auto s = std::string(1 << 16, 'a');
+	for (std::size_t i = 0; i < s.size(); i += 5) {
+		s[i] = 'b';
+	}
+	const auto sv = fsv::filtered_string_view{s, [](const char& c) { return c == 'b'; }};
+	auto threads = std::vector<std::thread>{};
+	auto sizes = std::vector<std::size_t>(4);
+	auto found = std::vector<const char*>(4);
+	for (std::size_t t = 0; t < 4; ++t) {
+		threads.emplace_back([&sv, &sizes, &found, t] {
+			found[t] = &sv.at(1000);
+			sizes[t] = sv.size();
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	for (std::size_t t = 0; t < 4; ++t) {
+		CHECK(sizes[t] == s.size() / 5 + 1);
+		CHECK(found[t] == s.data() + 5000);
+	}
+}
+
+TEST_CASE("basic_filtered_string_view with a concrete predicate type") {
+	auto not_space = [](const char& c) { return c != ' '; };
+	auto sv = fsv::basic_filtered_string_view{"german shepherd", not_space};
+	static_assert(std::is_same_v<decltype(sv)::predicate_type, decltype(not_space)>);
+	REQUIRE(sv.size() == 14);
+	REQUIRE(static_cast<std::string>(sv) == "germanshepherd");
+	REQUIRE(sv.at(6) == 's');
+	REQUIRE(std::string(sv.begin(), sv.end()) == "germanshepherd");
+
+	auto other = fsv::basic_filtered_string_view{"germans hepherd", not_space};
+	REQUIRE(sv == other);
+	REQUIRE((sv <=> other) == std::strong_ordering::equivalent);
+}
+
+TEST_CASE("views over a probed predicate use the table") {
+	auto calls = std::size_t{0};
+	auto is_vowel = [&calls](const char& c) {
+		++calls;
+		return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+	};
+	auto sv = fsv::filtered_string_view{"bernese mountain dog", fsv::probe(is_vowel)};
+	REQUIRE(calls == 256);
+	REQUIRE(sv.size() == 8);
+	REQUIRE(static_cast<std::string>(sv) == "eeeouaio");
+	REQUIRE(sv.at(3) == 'o');
+	REQUIRE(calls == 256);
+	REQUIRE(sv.predicate()('e'));
+}
+
+TEST_CASE("table predicates on a long buffer") {
+	auto s = std::string{};
+	for (int i = 0; i < 5000; ++i) {
+		s += "The quick brown fox jumps over the lazy dog. ";
+	}
+	auto is_alpha = [](const char& c) { return std::isalpha(static_cast<unsigned char>(c)) != 0; };
+	auto opaque = fsv::filtered_string_view{s, is_alpha};
+	auto table = fsv::filtered_string_view{s, fsv::probe(is_alpha)};
+
+	REQUIRE(table.size() == opaque.size());
+	REQUIRE(static_cast<std::string>(table) == static_cast<std::string>(opaque));
+	REQUIRE(table.at(123456) == opaque.at(123456));
+
+	std::ostringstream os;
+	os << table;
+	REQUIRE(os.str() == static_cast<std::string>(opaque));
+}
+
+TEST_CASE("compose folds table filters into one table") {
+	auto sv = fsv::filtered_string_view{"Newfoundland 1990"};
+	auto vf = std::vector<fsv::filter>{fsv::any_of(fsv::range('a', 'z'), fsv::range('0', '9')),
+	                                   fsv::not_(fsv::set("aeiou")),
+	                                   fsv::not_(fsv::set("9"))};
+	auto composed = fsv::compose(sv, vf);
+	REQUIRE(composed.predicate().target<fsv::char_class>() != nullptr);
+	REQUIRE(static_cast<std::string>(composed) == "wfndlnd10");
+}
+
+TEST_CASE("compose keeps opaque filters after the folded table") {
+	auto calls = std::size_t{0};
+	auto sv = fsv::filtered_string_view{"Newfoundland 1990"};
+	auto vf = std::vector<fsv::filter>{[&calls](const char& c) {
+		                                   ++calls;
+		                                   return c != 'd';
+	                                   },
+	                                   fsv::range('a', 'z')};
+	auto composed = fsv::compose(sv, vf);
+	// the opaque filter only sees what the table accepted
+	REQUIRE(composed.size() == 9);
+	REQUIRE(calls == 11);
+	REQUIRE(static_cast<std::string>(composed) == "ewfounlan");
+}
+
+TEST_CASE("adaptive compose exposes the order it chose") {
+	auto s = std::string(5000, 'x') + "abc";
+	auto sv = fsv::filtered_string_view{s};
+	auto vf = std::vector<fsv::filter>{[](const char&) { return true; }, [](const char& c) { return c != 'x'; }};
+
+	auto given = fsv::compose(sv, vf);
+	REQUIRE(given.predicate().target<fsv::filter_chain>()->order() == std::vector<std::size_t>{0, 1});
+
+	auto adaptive = fsv::compose(sv, vf, fsv::compose_order::adaptive);
+	REQUIRE(adaptive.predicate().target<fsv::filter_chain>()->order() == std::vector<std::size_t>{1, 0});
+	REQUIRE(static_cast<std::string>(adaptive) == "abc");
+	REQUIRE(adaptive == given);
+}
+
+TEST_CASE("compose keeps the bounds of the view it is given") {
+	auto prefix = fsv::substr(fsv::filtered_string_view{"hello world"}, 0, 5);
+	auto vf = std::vector<fsv::filter>{[](const char& c) { return c != 'l'; }};
+	REQUIRE(static_cast<std::string>(fsv::compose(prefix, vf)) == "heo");
+	REQUIRE(static_cast<std::string>(fsv::compose(prefix, {})) == "hello");
+	REQUIRE(static_cast<std::string>(fsv::compose(prefix, vf, fsv::compose_order::adaptive)) == "heo");
+
+	// no null terminator: composing must not read past the last byte
+	const char buffer[] = {'p', 'u', 'g', 's'};
+	auto pugs = fsv::filtered_string_view{std::begin(buffer), std::end(buffer)};
+	REQUIRE(static_cast<std::string>(fsv::compose(pugs, {fsv::range('a', 'z')}, fsv::compose_order::adaptive))
+	        == "pugs");
+	REQUIRE(fsv::compose(fsv::filtered_string_view{}, vf, fsv::compose_order::adaptive).empty());
+}
+
+TEST_CASE("bounded constructor views exactly [first, last)") {
+	const char buffer[] = {'p', 'u', 'g', 's'};
+	auto sv = fsv::filtered_string_view{buffer, buffer + 3};
+	REQUIRE(sv.size() == 3);
+	REQUIRE(sv == "pug");
+
+	auto pred = [](const char& c) { return c != 'u'; };
+	auto filtered = fsv::filtered_string_view{buffer + 1, buffer + 4, pred};
+	REQUIRE(static_cast<std::string>(filtered) == "gs");
+}
+
+TEST_CASE("substr keeps the parent predicate flat") {
+	auto sv = fsv::filtered_string_view{"Great Dane and Great Pyrenees", fsv::not_(fsv::set(" "))};
+	auto outer = fsv::substr(sv, 5, 15);
+	REQUIRE(outer == "DaneandGreatPyr");
+	auto inner = fsv::substr(outer, 4, 3);
+	REQUIRE(inner == "and");
+	REQUIRE(inner.predicate().target<fsv::char_class>() != nullptr);
+	REQUIRE(inner.data() == sv.data() + 11);
+
+	auto typed = fsv::basic_filtered_string_view{"a-b-c", [](const char& c) { return c != '-'; }};
+	auto typed_sub = fsv::substr(typed, 1);
+	static_assert(std::is_same_v<decltype(typed_sub), decltype(typed)>);
+	REQUIRE(static_cast<std::string>(typed_sub) == "bc");
+}
+
+TEST_CASE("substr never reads past the substring") {
+	const char buffer[] = {'b', 'o', 'x', 'e', 'r'};
+	auto sv = fsv::filtered_string_view{buffer, buffer + sizeof(buffer)};
+	auto sub = fsv::substr(sv, 1, 3);
+	REQUIRE(sub.size() == 3);
+	REQUIRE(static_cast<std::string>(sub) == "oxe");
+}
+
+TEST_CASE("substr of length 0") {
+	auto sv = fsv::filtered_string_view{"Akita"};
+	REQUIRE(fsv::substr(sv, 5) == "");
+	REQUIRE(fsv::substr(sv, 5).empty());
+	REQUIRE(fsv::substr(sv, 2, 0) == "ita");
+	REQUIRE_THROWS_AS(fsv::substr(sv, 6), std::domain_error);
+	REQUIRE_THROWS_AS(fsv::substr(sv, 3, 5), std::domain_error);
+}
+
+TEST_CASE("split does not read past a delimiter prefix at the end") {
+	auto sv = fsv::filtered_string_view{"abx"};
+	auto tok = fsv::filtered_string_view{"xy"};
+	auto v = fsv::split(sv, tok);
+	REQUIRE(v.size() == 1);
+	CHECK(v[0] == sv);
+	CHECK(v[0].data() == sv.data());
+}
+
+TEST_CASE("split a long buffer on newlines") {
+	auto buffer = std::string{};
+	for (int line = 0; line < 100000; ++line) {
+		buffer += std::to_string(line) + '\n';
+	}
+	auto sv = fsv::filtered_string_view{buffer};
+	auto v = fsv::split(sv, fsv::filtered_string_view{"\n"});
+	REQUIRE(v.size() == 100001);
+	CHECK(static_cast<std::string>(v[0]) == "0");
+	CHECK(static_cast<std::string>(v[12345]) == "12345");
+	CHECK(v[99999].size() == 5);
+	CHECK(v.back().empty());
+}
+
+TEST_CASE("split with a multi-character delimiter agrees across predicates") {
+	auto buffer = std::string{};
+	for (int i = 0; i < 2000; ++i) {
+		buffer += (i % 7 == 0) ? "<->" : (i % 3 == 0 ? "<-" : "ab");
+	}
+	auto expected = std::vector<std::string>{};
+	for (std::size_t pos = 0;;) {
+		auto next = buffer.find("<->", pos);
+		expected.push_back(buffer.substr(pos, next == std::string::npos ? std::string::npos : next - pos));
+		if (next == std::string::npos) {
+			break;
+		}
+		pos = next + 3;
+	}
+
+	auto tok = fsv::filtered_string_view{"<->"};
+	auto unfiltered = fsv::filtered_string_view{buffer};
+	auto opaque = fsv::filtered_string_view{buffer, [](const char& c) { return c != '\0'; }};
+	auto table = fsv::filtered_string_view{buffer, ~fsv::char_class{}.insert('\0')};
+	for (const auto& sv : {unfiltered, opaque, table}) {
+		auto v = fsv::split(sv, tok);
+		REQUIRE(v.size() == expected.size());
+		for (std::size_t i = 0; i < v.size(); ++i) {
+			CHECK(static_cast<std::string>(v[i]) == expected[i]);
+		}
+	}
+}
+
+TEST_CASE("split matches delimiters across filtered-out bytes") {
+	auto sv = fsv::filtered_string_view{"a-b,-,c-d,,e", [](const char& c) { return c != '-'; }};
+	auto v = fsv::split(sv, fsv::filtered_string_view{",,"});
+	auto expected = std::vector<fsv::filtered_string_view>{"ab", "cd", "e"};
+	CHECK(v == expected);
+}
+
+TEST_CASE("split on a table predicate with a single-character delimiter") {
+	auto digits = fsv::range('0', '9') | fsv::char_class{}.insert(',');
+	auto sv = fsv::basic_filtered_string_view<fsv::char_class>{"1a,2b2,,c3", digits};
+	auto v = fsv::split(sv, fsv::filtered_string_view{","});
+	REQUIRE(v.size() == 4);
+	CHECK(static_cast<std::string>(v[0]) == "1");
+	CHECK(static_cast<std::string>(v[1]) == "22");
+	CHECK(v[2].empty());
+	CHECK(static_cast<std::string>(v[3]) == "3");
+}
+
+TEST_CASE("split_view yields tokens lazily") {
+	auto sv = fsv::filtered_string_view{"one two  three"};
+	auto tokens = fsv::split_view{sv, fsv::filtered_string_view{" "}};
+	auto it = tokens.begin();
+	REQUIRE(it != tokens.end());
+	CHECK(static_cast<std::string>(*it) == "one");
+	CHECK((++it)->size() == 3);
+	CHECK((++it)->empty());
+	CHECK(static_cast<std::string>(*++it) == "three");
+	CHECK(++it == tokens.end());
+
+	auto count = std::ranges::distance(tokens);
+	CHECK(count == 4);
+	STATIC_REQUIRE(std::forward_iterator<decltype(tokens.begin())>);
+}
+
+TEST_CASE("iterating a view calls the predicate once per byte") {
+	auto s = std::string(10000, 'a');
+	for (std::size_t i = 0; i < s.size(); i += 5) {
+		s[i] = 'b';
+	}
+	auto calls = std::size_t{0};
+	auto sv = fsv::filtered_string_view{s, [&calls](const char& c) {
+		                                    ++calls;
+		                                    return c == 'b';
+	                                    }};
+	auto seen = std::size_t{0};
+	for (auto c : sv) {
+		REQUIRE(c == 'b');
+		++seen;
+	}
+	CHECK(seen == 2000);
+	CHECK(calls == s.size());
+
+	calls = 0;
+	auto reversed = std::string(sv.rbegin(), sv.rend());
+	CHECK(reversed == std::string(2000, 'b'));
+	// std::string measures the range first, and std::reverse_iterator steps back again on every dereference
+	CHECK(calls < 4 * s.size());
+}
+
+TEST_CASE("iterators skip rejected bytes at both ends") {
+	auto sv = fsv::filtered_string_view{"--ab-c--", [](const char& c) { return c != '-'; }};
+	CHECK(std::string(sv.begin(), sv.end()) == "abc");
+	CHECK(std::string(sv.rbegin(), sv.rend()) == "cba");
+	CHECK(std::distance(sv.begin(), sv.end()) == 3);
+	CHECK(*std::prev(sv.end()) == 'c');
+
+	auto none = fsv::filtered_string_view{"----", [](const char& c) { return c != '-'; }};
+	CHECK(none.begin() == none.end());
+	auto empty = fsv::filtered_string_view{};
+	CHECK(empty.begin() == empty.end());
+}
+
+TEST_CASE("indexed() is a random-access range over the same characters") {
+	auto sv = fsv::filtered_string_view{"b-e-a-g-l-e", [](const char& c) { return c != '-'; }};
+	auto chars = sv.indexed();
+	STATIC_REQUIRE(std::random_access_iterator<decltype(chars.begin())>);
+	STATIC_REQUIRE(std::ranges::random_access_range<decltype(chars)>);
+	REQUIRE(chars.size() == 6);
+	CHECK(std::string(chars.begin(), chars.end()) == "beagle");
+	CHECK(chars[3] == 'g');
+	CHECK(*(chars.begin() + 5) == 'e');
+	CHECK(chars.end() - chars.begin() == 6);
+	CHECK(&*(chars.end() - 1) == sv.data() + 10);
+	CHECK(std::string(std::make_reverse_iterator(chars.end()), std::make_reverse_iterator(chars.begin())) == "elgaeb");
+
+	CHECK(fsv::filtered_string_view{}.indexed().empty());
+}
+
+TEST_CASE("indexed() of an unfiltered view addresses the raw bytes") {
+	auto s = std::string{"dalmatian"};
+	for (const auto& sv : {fsv::filtered_string_view{s}, fsv::filtered_string_view{s, fsv::char_class::all()}}) {
+		auto chars = sv.indexed();
+		REQUIRE(chars.size() == s.size());
+		CHECK(std::string(chars.begin(), chars.end()) == s);
+		for (std::size_t i = 0; i < s.size(); ++i) {
+			CHECK(&chars[static_cast<std::ptrdiff_t>(i)] == s.data() + i);
+		}
+	}
+}
+
+TEST_CASE("indexed() binary searches sorted filtered records") {
+	auto buffer = std::string{};
+	for (int i = 0; i < 26 * 400; ++i) {
+		buffer += static_cast<char>('a' + i / 400);
+		buffer += "--";
+	}
+	auto sv = fsv::filtered_string_view{buffer, [](const char& c) { return c != '-'; }};
+	auto chars = sv.indexed();
+	REQUIRE(std::ranges::is_sorted(chars));
+	auto q = std::ranges::equal_range(chars, 'q');
+	CHECK(q.begin() - chars.begin() == 16 * 400);
+	CHECK(q.size() == 400);
+	CHECK(std::ranges::lower_bound(chars, 'z') == chars.begin() + 25 * 400);
+}
+
+TEST_CASE("runs() yields the maximal accepted runs") {
+	auto s = std::string{"  the quick  brown fox "};
+	auto not_space = [](const char& c) { return c != ' '; };
+	auto expected = std::vector<std::string_view>{"the", "quick", "brown", "fox"};
+
+	auto sv = fsv::filtered_string_view{s, not_space};
+	auto runs = std::vector<std::string_view>{};
+	sv.for_each_run([&runs](std::string_view run) { runs.push_back(run); });
+	CHECK(runs == expected);
+	CHECK(runs[1].data() == s.data() + 6);
+
+	auto table = fsv::filtered_string_view{s, ~fsv::char_class{}.insert(' ')};
+	auto table_runs = std::vector<std::string_view>{};
+	for (auto run : table.runs()) {
+		table_runs.push_back(run);
+	}
+	CHECK(table_runs == expected);
+
+	auto whole = fsv::filtered_string_view{s};
+	CHECK(std::ranges::distance(whole.runs()) == 1);
+	CHECK(*whole.runs().begin() == s);
+
+	CHECK(fsv::filtered_string_view{}.runs().empty());
+	CHECK(fsv::filtered_string_view{"   ", not_space}.runs().empty());
+}
+
+TEST_CASE("runs() of a table view match an opaque predicate on a long buffer") {
+	auto s = std::string{};
+	for (int i = 0; i < 20000; ++i) {
+		s += static_cast<char>(" ab,c\td"[(i * 7 + i / 13) % 7]);
+	}
+	auto sep = fsv::char_class{}.insert(' ').insert(',').insert('\t');
+	auto opaque = fsv::filtered_string_view{s, [&sep](const char& c) { return not sep(c); }};
+	auto table = fsv::filtered_string_view{s, ~sep};
+
+	auto opaque_runs = std::vector<std::string_view>{};
+	opaque.for_each_run([&](std::string_view run) { opaque_runs.push_back(run); });
+	auto table_runs = std::vector<std::string_view>{};
+	table.for_each_run([&](std::string_view run) { table_runs.push_back(run); });
+	REQUIRE(table_runs.size() == opaque_runs.size());
+	for (std::size_t i = 0; i < table_runs.size(); ++i) {
+		REQUIRE(table_runs[i].data() == opaque_runs[i].data());
+		REQUIRE(table_runs[i].size() == opaque_runs[i].size());
+	}
+
+	auto joined = std::string{};
+	for (auto run : table.runs()) {
+		joined += run;
+	}
+	CHECK(joined == static_cast<std::string>(opaque));
+}
+
+TEST_CASE("operator<< calls the predicate once per byte") {
+	auto s = std::string{};
+	for (int i = 0; i < 5000; ++i) {
+		s += (i % 4 == 0) ? " ; " : "log";
+	}
+	auto calls = std::size_t{0};
+	auto sv = fsv::filtered_string_view{s, [&calls](const char& c) {
+		                                    ++calls;
+		                                    return c != ' ';
+	                                    }};
+	std::ostringstream os;
+	os << sv;
+	CHECK(calls == s.size());
+
+	auto expected = s;
+	std::erase(expected, ' ');
+	CHECK(os.str() == expected);
+}
+
+TEST_CASE("operator<< writes through failing and unfiltered streams") {
+	auto whole = fsv::filtered_string_view{"shiba inu"};
+	std::ostringstream os;
+	os << whole << '|' << fsv::filtered_string_view{} << '|';
+	CHECK(os.str() == "shiba inu||");
+
+	os.setstate(std::ios_base::failbit);
+	os << whole;
+	CHECK(os.str() == "shiba inu||");
+}
+
+TEST_CASE("copy_to() fills at most the destination") {
+	auto sv = fsv::filtered_string_view{"k-e-l-p-i-e", [](const char& c) { return c != '-'; }};
+	auto out = std::array<char, 4>{};
+	CHECK(sv.copy_to(out) == 4);
+	CHECK(std::string(out.begin(), out.end()) == "kelp");
+
+	auto wide = std::string(10, '#');
+	CHECK(sv.copy_to(wide) == 6);
+	CHECK(wide.substr(0, 6) == "kelpie");
+
+	CHECK(wide.substr(6) == "####");
+
+	// nothing past the count is written, even where a rejected byte or a whole vector was stored before compaction
+	auto text = std::string{};
+	for (int i = 0; i < 300; ++i) {
+		text += "kelpie-";
+	}
+	for (const auto& pred : {fsv::filter{[](const char& c) { return c != '-'; }},
+	                         fsv::filter{~fsv::char_class{}.insert('-')}}) {
+		auto trailing = fsv::filtered_string_view{text, pred};
+		auto out = std::string(text.size(), '#');
+		REQUIRE(trailing.copy_to(out) == 6 * 300);
+		CHECK(out.substr(0, 12) == "kelpiekelpie");
+		CHECK(out.substr(6 * 300) == std::string(300, '#'));
+	}
+
+	auto whole = fsv::filtered_string_view{"whippet"};
+	CHECK(whole.copy_to(out) == 4);
+	CHECK(std::string(out.begin(), out.end()) == "whip");
+	CHECK(fsv::filtered_string_view{}.copy_to(out) == 0);
+}
+
+TEST_CASE("materialize_into() reuses the destination's capacity") {
+	auto s = std::string{};
+	for (int i = 0; i < 3000; ++i) {
+		s += "a,b;";
+	}
+	auto expected = std::string{};
+	for (int i = 0; i < 3000; ++i) {
+		expected += "ab";
+	}
+	auto opaque = fsv::filtered_string_view{s, [](const char& c) { return c >= 'a' and c <= 'z'; }};
+	auto table = fsv::filtered_string_view{s, fsv::range('a', 'z')};
+
+	auto out = std::string{};
+	out.reserve(s.size());
+	const auto* storage = out.data();
+	for (const auto& sv : {opaque, table, fsv::filtered_string_view{s}}) {
+		sv.materialize_into(out);
+		CHECK(out.data() == storage);
+	}
+	CHECK(out == s);
+	opaque.materialize_into(out);
+	CHECK(out == expected);
+	table.materialize_into(out);
+	CHECK(out == expected);
+
+	fsv::filtered_string_view{}.materialize_into(out);
+	CHECK(out.empty());
+}
+
+TEST_CASE("write_to_fd() writes the filtered characters") {
+	auto s = std::string{};
+	for (int i = 0; i < 20000; ++i) {
+		s += (i % 3 == 0) ? "<tag>" : "text-";
+	}
+	auto no_tags = fsv::filtered_string_view{s, [](const char& c) { return c != '<' and c != '>'; }};
+	std::FILE* file = std::tmpfile();
+	REQUIRE(file != nullptr);
+	CHECK(no_tags.write_to_fd(fileno(file)) == no_tags.size());
+	CHECK(fsv::filtered_string_view{}.write_to_fd(fileno(file)) == 0);
+
+	auto contents = std::string(no_tags.size(), '\0');
+	std::rewind(file);
+	CHECK(std::fread(contents.data(), 1, contents.size(), file) == contents.size());
+	std::fclose(file);
+	CHECK(contents == static_cast<std::string>(no_tags));
+}
+
+TEST_CASE("at() and substr() take any integer type") {
+	auto sv = fsv::filtered_string_view{"b-a-s-e-n-j-i", [](const char& c) { return c != '-'; }};
+	CHECK(sv.at(std::size_t{2}) == 's');
+	CHECK(sv.at(std::ptrdiff_t{6}) == 'i');
+	CHECK(sv[3u] == 'e');
+	CHECK(sv[4L] == 'n');
+	REQUIRE_THROWS_AS(sv.at(std::ptrdiff_t{-1}), std::domain_error);
+	REQUIRE_THROWS_AS(sv.at(std::size_t{7}), std::domain_error);
+
+	CHECK(static_cast<std::string>(fsv::substr(sv, std::size_t{1}, std::size_t{3})) == "ase");
+	CHECK(static_cast<std::string>(fsv::substr(sv, std::size_t{4})) == "nji");
+	CHECK(static_cast<std::string>(fsv::substr(sv, 5L, -1)) == "ji");
+	CHECK(fsv::substr(sv, std::size_t{7}).empty());
+	REQUIRE_THROWS_AS(fsv::substr(sv, std::size_t{9}), std::domain_error);
+	REQUIRE_THROWS_AS(fsv::substr(sv, -1, 2), std::domain_error);
+}
+
+TEST_CASE("views over inline_filter and filter_ref predicates") {
+	auto not_dash = [](const char& c) { return c != '-'; };
+	auto owned = fsv::basic_filtered_string_view<fsv::inline_filter>{"c-o-r-g-i", not_dash};
+	auto borrowed = fsv::basic_filtered_string_view<fsv::filter_ref>{"c-o-r-g-i", not_dash};
+	CHECK(static_cast<std::string>(owned) == "corgi");
+	CHECK(static_cast<std::string>(borrowed) == "corgi");
+
+	auto tokens = fsv::split(owned, fsv::filtered_string_view{"r"});
+	REQUIRE(tokens.size() == 2);
+	CHECK(static_cast<std::string>(tokens[1]) == "gi");
+
+	auto moved = std::move(owned);
+	CHECK(moved.predicate().target<decltype(not_dash)>() != nullptr);
+	CHECK(static_cast<std::string>(moved) == "corgi");
+
+	auto unfiltered = fsv::basic_filtered_string_view<fsv::filter_ref>{"pug"};
+	CHECK(unfiltered.size() == 3);
+}
+
+TEST_CASE("the default predicate is accept_all") {
+	auto sv = fsv::filtered_string_view{"pomeranian"};
+	REQUIRE(sv.predicate().target<fsv::accept_all>() != nullptr);
+	CHECK(sv.size() == 10);
+	CHECK(static_cast<std::string>(sv) == "pomeranian");
+	CHECK(&sv.at(4) == sv.data() + 4);
+
+	auto explicit_all = fsv::basic_filtered_string_view{"poodle", fsv::accept_all{}};
+	CHECK(explicit_all.size() == 6);
+	CHECK(static_cast<std::string>(fsv::substr(explicit_all, 1, 3)) == "ood");
+}
+
+TEST_CASE("unfiltered comparisons agree with filtered ones") {
+	auto keep = [](const char&) { return true; };
+	auto words = std::vector<std::string>{"", "a", "ab", "b", std::string(100, 'x'), std::string(100, 'x') + "y",
+	                                      std::string(70, 'x') + "\x80", std::string(70, 'x') + "a"};
+	for (const auto& lhs : words) {
+		for (const auto& rhs : words) {
+			auto plain_lhs = fsv::filtered_string_view{lhs};
+			auto plain_rhs = fsv::filtered_string_view{rhs};
+			auto kept_lhs = fsv::filtered_string_view{lhs, keep};
+			auto kept_rhs = fsv::filtered_string_view{rhs, keep};
+			CHECK((plain_lhs == plain_rhs) == (lhs == rhs));
+			CHECK((plain_lhs <=> plain_rhs) == (kept_lhs <=> kept_rhs));
+		}
+	}
+}
+
+TEST_CASE("comparisons line up runs that break in different places") {
+	auto no_spaces = fsv::filter{[](const char& c) { return c != ' '; }};
+	auto no_dashes = fsv::filter{[](const char& c) { return c != '-'; }};
+	auto texts = std::vector<std::string>{"", " ", "ab c", "a-bc", "abc", "ab-c-", "abd", "ab", "a\x80", "a b\x80",
+	                                      std::string(200, 'x'), std::string(100, 'x') + " " + std::string(100, 'x')};
+	for (const auto& lhs : texts) {
+		for (const auto& rhs : texts) {
+			auto lhs_view = fsv::filtered_string_view{lhs, no_spaces};
+			auto rhs_view = fsv::filtered_string_view{rhs, no_dashes};
+			auto lhs_chars = static_cast<std::string>(lhs_view);
+			auto rhs_chars = static_cast<std::string>(rhs_view);
+			CHECK((lhs_view == rhs_view) == (lhs_chars == rhs_chars));
+			CHECK((lhs_view <=> rhs_view)
+			      == std::lexicographical_compare_three_way(lhs_chars.begin(),
+			                                                lhs_chars.end(),
+			                                                rhs_chars.begin(),
+			                                                rhs_chars.end()));
+		}
+	}
+}
+
+TEST_CASE("comparisons of char_class views agree across compacted blocks") {
+	auto no_spaces = fsv::filter{~fsv::char_class{}.insert(' ')};
+	auto no_dashes = fsv::filter{~fsv::char_class{}.insert('-')};
+	auto no_dashes_lambda = fsv::filter{[](const char& c) { return c != '-'; }};
+	auto base = std::string{};
+	for (int i = 0; i < 6000; ++i) {
+		base += static_cast<char>('a' + i % 26);
+		base += i % 3 == 0 ? " -" : "";
+	}
+	auto texts = std::vector<std::string>{"", base, base.substr(0, 4096), base.substr(0, 4097), base + "z"};
+	for (const auto at : {std::size_t{0}, std::size_t{4095}, std::size_t{4096}, std::size_t{8191}, base.size() - 1}) {
+		auto changed = base;
+		changed[at] = changed[at] == 'q' ? 'r' : 'q';
+		texts.push_back(changed);
+	}
+	for (const auto& lhs : texts) {
+		for (const auto& rhs : texts) {
+			auto lhs_view = fsv::filtered_string_view{lhs, no_spaces};
+			auto lhs_chars = static_cast<std::string>(lhs_view);
+			for (const auto& rhs_pred : {no_dashes, no_dashes_lambda}) {
+				auto rhs_view = fsv::filtered_string_view{rhs, rhs_pred};
+				auto rhs_chars = static_cast<std::string>(rhs_view);
+				CHECK((lhs_view == rhs_view) == (lhs_chars == rhs_chars));
+				CHECK((lhs_view <=> rhs_view)
+				      == std::lexicographical_compare_three_way(lhs_chars.begin(),
+				                                                lhs_chars.end(),
+				                                                rhs_chars.begin(),
+				                                                rhs_chars.end()));
+			}
+		}
+	}
+}
+
+TEST_CASE("comparisons stop at the first difference") {
+	auto tail = std::string{};
+	for (int i = 0; i < 50000; ++i) {
+		tail += " x";
+	}
+	auto lhs = "a" + tail;
+	auto rhs = "b" + tail;
+	auto calls = std::size_t{0};
+	auto counted = fsv::filter{[&calls](const char& c) {
+		++calls;
+		return c != ' ';
+	}};
+	auto lhs_view = fsv::filtered_string_view{lhs, counted};
+	auto rhs_view = fsv::filtered_string_view{rhs, counted};
+	CHECK(lhs_view != rhs_view);
+	CHECK(lhs_view < rhs_view);
+	// only the first run of each side is found
+	CHECK(calls <= 8);
+
+	calls = 0;
+	auto same = fsv::filtered_string_view{lhs, counted};
+	CHECK(lhs_view == same);
+	CHECK(calls <= 2 * (lhs.size() + 1));
+}
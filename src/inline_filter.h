@@ -0,0 +1,156 @@
+#ifndef COMP6771_ASS2_INLINE_FILTER_H
+#define COMP6771_ASS2_INLINE_FILTER_H
+
+#include "./char_class.h"
+#include "./predicates.h"
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fsv {
+	// A type-erased bool(const char&) that always stores its callable inside itself. Callables that do not fit in
+	// Capacity bytes, or need more than max_align_t alignment, are rejected at compile time rather than moved to the
+	// heap, so copying, moving and destroying one never allocates. Moving steals the callable.
+	template<std::size_t Capacity = 4 * sizeof(void*)>
+	class basic_inline_filter {
+		template<typename F>
+		static constexpr bool fits = sizeof(F) <= Capacity and alignof(F) <= alignof(std::max_align_t)
+		                             and std::is_nothrow_move_constructible_v<F> and std::copy_constructible<F>;
+
+	 public:
+		static constexpr std::size_t capacity = Capacity;
+
+		template<typename F>
+		requires(not std::same_as<std::remove_cvref_t<F>, basic_inline_filter>
+		         and std::predicate<const std::remove_cvref_t<F>&, const char&> and fits<std::remove_cvref_t<F>>)
+		basic_inline_filter(F&& f) noexcept(std::is_nothrow_constructible_v<std::remove_cvref_t<F>, F>)
+		: ops_{&ops_for<std::remove_cvref_t<F>>} {
+			::new (static_cast<void*>(storage_)) std::remove_cvref_t<F>(std::forward<F>(f));
+		}
+
+		basic_inline_filter(const basic_inline_filter& other)
+		: ops_{other.ops_} {
+			ops_->copy(other.storage_, storage_);
+		}
+		basic_inline_filter(basic_inline_filter&& other) noexcept
+		: ops_{other.ops_} {
+			ops_->move(other.storage_, storage_);
+		}
+
+		auto operator=(const basic_inline_filter& other) -> basic_inline_filter& {
+			if (this != &other) {
+				auto copy = other;
+				*this = std::move(copy);
+			}
+			return *this;
+		}
+		auto operator=(basic_inline_filter&& other) noexcept -> basic_inline_filter& {
+			if (this != &other) {
+				ops_->destroy(storage_);
+				ops_ = other.ops_;
+				ops_->move(other.storage_, storage_);
+			}
+			return *this;
+		}
+
+		~basic_inline_filter() noexcept {
+			ops_->destroy(storage_);
+		}
+
+		auto operator()(const char& c) const -> bool {
+			return ops_->call(storage_, c);
+		}
+
+		// the stored callable if it is a T, like std::function::target
+		template<typename T>
+		[[nodiscard]] auto target() const noexcept -> const T* {
+			if (ops_ != &ops_for<T>) {
+				return nullptr;
+			}
+			return std::launder(static_cast<const T*>(static_cast<const void*>(storage_)));
+		}
+
+	 private:
+		struct ops {
+			bool (*call)(const void* self, const char& c);
+			void (*copy)(const void* from, void* to);
+			void (*move)(void* from, void* to) noexcept;
+			void (*destroy)(void* self) noexcept;
+		};
+
+		template<typename F>
+		static constexpr auto ops_for = ops{
+		    [](const void* self, const char& c) -> bool {
+			    return static_cast<bool>((*static_cast<const F*>(self))(c));
+		    },
+		    [](const void* from, void* to) { ::new (to) F(*static_cast<const F*>(from)); },
+		    [](void* from, void* to) noexcept { ::new (to) F(std::move(*static_cast<F*>(from))); },
+		    [](void* self) noexcept { static_cast<F*>(self)->~F(); },
+		};
+
+		alignas(std::max_align_t) std::byte storage_[Capacity];
+		const ops* ops_;
+	};
+
+	using inline_filter = basic_inline_filter<>;
+
+	// A non-owning reference to a bool(const char&) callable: two pointers, trivially copyable, and never allocates.
+	// The callable must outlive every filter_ref to it, and so every view filtered through one; binding a temporary
+	// is rejected for that reason.
+	class filter_ref {
+	 public:
+		template<typename F>
+		requires(std::is_object_v<F> and not std::same_as<F, filter_ref> and std::predicate<const F&, const char&>)
+		filter_ref(const F& f) noexcept
+		: object_{std::addressof(f)}
+		, call_{&invoke<F>} {}
+		template<typename F>
+		requires(not std::same_as<F, filter_ref>)
+		filter_ref(const F&&) = delete;
+
+		auto operator()(const char& c) const -> bool {
+			return call_(object_, c);
+		}
+
+		// the referenced callable if it is a T
+		template<typename T>
+		[[nodiscard]] auto target() const noexcept -> const T* {
+			return call_ == &invoke<T> ? static_cast<const T*>(object_) : nullptr;
+		}
+
+	 private:
+		template<typename F>
+		static auto invoke(const void* object, const char& c) -> bool {
+			return static_cast<bool>((*static_cast<const F*>(object))(c));
+		}
+
+		const void* object_;
+		bool (*call_)(const void*, const char&);
+	};
+
+	namespace detail {
+		template<std::size_t Capacity>
+		[[nodiscard]] auto table_of(const basic_inline_filter<Capacity>& predicate) noexcept -> const char_class* {
+			return predicate.template target<char_class>();
+		}
+
+		[[nodiscard]] inline auto table_of(const filter_ref& predicate) noexcept -> const char_class* {
+			return predicate.target<char_class>();
+		}
+
+		template<std::size_t Capacity>
+		[[nodiscard]] auto is_accept_all(const basic_inline_filter<Capacity>& predicate) noexcept -> bool {
+			return predicate.template target<accept_all>() != nullptr;
+		}
+
+		[[nodiscard]] inline auto is_accept_all(const filter_ref& predicate) noexcept -> bool {
+			return predicate.target<accept_all>() != nullptr;
+		}
+	} // namespace detail
+} // namespace fsv
+
+#endif // COMP6771_ASS2_INLINE_FILTER_H
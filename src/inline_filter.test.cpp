@@ -0,0 +1,111 @@
+#include "./inline_filter.h"
+#include "./filtered_string_view.h"
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace {
+	std::size_t allocations = 0;
+} // namespace
+
+// counts every allocation in this test program, so that the tests below can check that none happen
+auto operator new(std::size_t size) -> void* {
+	++allocations;
+	if (void* p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+TEST_CASE("inline_filter calls, copies and moves its callable in place") {
+	auto banned = std::array<char, 3>{'x', 'y', 'z'};
+	auto not_banned = [banned](const char& c) { return c != banned[0] and c != banned[1] and c != banned[2]; };
+
+	const auto before = allocations;
+	auto filter = fsv::inline_filter{not_banned};
+	auto copy = filter;
+	auto moved = std::move(copy);
+	copy = moved;
+	filter = std::move(moved);
+	CHECK(allocations == before);
+
+	CHECK(filter('a'));
+	CHECK(not filter('y'));
+	CHECK(copy('b'));
+	CHECK(filter.target<decltype(not_banned)>() != nullptr);
+	CHECK(filter.target<fsv::char_class>() == nullptr);
+}
+
+TEST_CASE("inline_filter rejects callables that do not fit") {
+	auto small = [](const char&) { return true; };
+	auto large = [buffer = std::array<char, 64>{}](const char& c) { return buffer[0] == c; };
+	STATIC_REQUIRE(std::is_constructible_v<fsv::inline_filter, decltype(small)>);
+	STATIC_REQUIRE(not std::is_constructible_v<fsv::inline_filter, decltype(large)>);
+	STATIC_REQUIRE(std::is_constructible_v<fsv::basic_inline_filter<64>, decltype(large)>);
+}
+
+TEST_CASE("inline_filter and filter_ref expose a char_class to the scanning loops") {
+	const auto digits = fsv::char_class{}.insert('0').insert('1');
+	const auto owned = fsv::inline_filter{digits};
+	const auto ref = fsv::filter_ref{digits};
+	REQUIRE(fsv::detail::table_of(owned) != nullptr);
+	CHECK(*fsv::detail::table_of(owned) == digits);
+	CHECK(fsv::detail::table_of(ref) == &digits);
+	CHECK(owned('1'));
+	CHECK(not ref('2'));
+}
+
+TEST_CASE("filter_ref refers to its callable without copying it") {
+	auto calls = 0;
+	auto counting = [&calls](const char& c) {
+		++calls;
+		return c == 'k';
+	};
+	const auto before = allocations;
+	auto ref = fsv::filter_ref{counting};
+	auto copy = ref;
+	CHECK(allocations == before);
+	CHECK(copy('k'));
+	CHECK(not ref('j'));
+	CHECK(calls == 2);
+	CHECK(ref.target<decltype(counting)>() == &counting);
+	STATIC_REQUIRE(std::is_trivially_copyable_v<fsv::filter_ref>);
+	STATIC_REQUIRE(not std::is_constructible_v<fsv::filter_ref, decltype([](const char&) { return true; })>);
+}
+
+TEST_CASE("views over inline_filter and filter_ref with the default predicate are unfiltered") {
+	const auto owned = fsv::basic_filtered_string_view<fsv::inline_filter>{"pug"};
+	const auto borrowed = fsv::basic_filtered_string_view<fsv::filter_ref>{"pug"};
+	// accept_all is held directly, not through the std::function default_predicate
+	CHECK(owned.predicate().target<fsv::accept_all>() != nullptr);
+	CHECK(borrowed.predicate().target<fsv::accept_all>() != nullptr);
+	CHECK(owned.predicate().target<fsv::filter>() == nullptr);
+	CHECK(borrowed.predicate().target<fsv::filter>() == nullptr);
+
+	// a filtered view builds its rank/select index on the first at(), which allocates; an unfiltered one indexes the
+	// raw bytes
+	const auto before = allocations;
+	CHECK(&owned.at(2) == owned.data() + 2);
+	CHECK(&borrowed.at(2) == borrowed.data() + 2);
+	CHECK(allocations == before);
+
+	const auto all = fsv::char_class::all();
+	auto moved_from = fsv::basic_filtered_string_view<fsv::filter_ref>{"pug", all};
+	auto moved_to = std::move(moved_from);
+	CHECK(moved_from.predicate().target<fsv::accept_all>() != nullptr);
+	CHECK(moved_to.size() == 3);
+}
@@ -0,0 +1,115 @@
+#include "./mapped_source.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fsv {
+	namespace {
+		[[noreturn]] void fail(int error, const std::string& what) {
+			throw std::system_error{error, std::generic_category(), "mapped_source: " + what};
+		}
+
+		// closes the descriptor once the mapping, which does not need it, has been made
+		class file_descriptor {
+		 public:
+			explicit file_descriptor(int fd) noexcept
+			: fd_{fd} {}
+			file_descriptor(const file_descriptor&) = delete;
+			auto operator=(const file_descriptor&) -> file_descriptor& = delete;
+			~file_descriptor() noexcept {
+				if (fd_ >= 0) {
+					::close(fd_);
+				}
+			}
+
+			[[nodiscard]] auto get() const noexcept -> int {
+				return fd_;
+			}
+
+		 private:
+			int fd_;
+		};
+	} // namespace
+
+	mapped_source::mapped_source(const std::string& path, map_options options) {
+		const auto fd = file_descriptor{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+		if (fd.get() < 0) {
+			fail(errno, "cannot open " + path);
+		}
+		struct stat info = {};
+		if (::fstat(fd.get(), &info) != 0) {
+			fail(errno, "cannot stat " + path);
+		}
+		size_ = static_cast<std::size_t>(info.st_size);
+		if (size_ == 0) {
+			// mmap rejects empty mappings, and an empty view needs no storage
+			return;
+		}
+
+		auto flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+		if (options.populate) {
+			flags |= MAP_POPULATE;
+		}
+#endif
+		void* mapping = ::mmap(nullptr, size_, PROT_READ, flags, fd.get(), 0);
+		if (mapping == MAP_FAILED) {
+			size_ = 0;
+			fail(errno, "cannot map " + path);
+		}
+		data_ = static_cast<const char*>(mapping);
+
+		// the advice is only a hint, so failures (such as huge pages on a file system without them) are ignored
+		if (options.sequential) {
+			::madvise(mapping, size_, MADV_SEQUENTIAL);
+		}
+#if defined(MADV_HUGEPAGE)
+		if (options.huge_pages) {
+			::madvise(mapping, size_, MADV_HUGEPAGE);
+		}
+#endif
+	}
+
+	mapped_source::mapped_source(mapped_source&& other) noexcept
+	: data_{std::exchange(other.data_, nullptr)}
+	, size_{std::exchange(other.size_, 0)} {}
+
+	auto mapped_source::operator=(mapped_source&& other) noexcept -> mapped_source& {
+		if (this != &other) {
+			unmap();
+			data_ = std::exchange(other.data_, nullptr);
+			size_ = std::exchange(other.size_, 0);
+		}
+		return *this;
+	}
+
+	mapped_source::~mapped_source() noexcept {
+		unmap();
+	}
+
+	auto mapped_source::data() const noexcept -> const char* {
+		return data_;
+	}
+
+	auto mapped_source::size() const noexcept -> std::size_t {
+		return size_;
+	}
+
+	auto mapped_source::view() const noexcept -> filtered_string_view {
+		return filtered_string_view{data_, data_ + size_};
+	}
+
+	void mapped_source::unmap() noexcept {
+		if (data_ != nullptr) {
+			// munmap takes a non-const pointer but does not write through it
+			::munmap(const_cast<char*>(data_), size_);
+			data_ = nullptr;
+			size_ = 0;
+		}
+	}
+} // namespace fsv
@@ -0,0 +1,50 @@
+#ifndef COMP6771_ASS2_MAPPED_SOURCE_H
+#define COMP6771_ASS2_MAPPED_SOURCE_H
+
+#include "./filtered_string_view.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace fsv {
+	struct map_options {
+		// advise the kernel that the mapping is read front to back, for aggressive readahead
+		bool sequential = true;
+		// ask for transparent huge pages where the file system supports them
+		bool huge_pages = true;
+		// fault the whole file in up front instead of on first touch
+		bool populate = false;
+	};
+
+	// A read-only private mapping of a whole file that owns the mapping and hands out views over it. Views do not
+	// keep the mapping alive: they must not outlive the mapped_source they came from. Throws std::system_error if
+	// the file cannot be opened or mapped.
+	class mapped_source {
+	 public:
+		explicit mapped_source(const std::string& path, map_options options = {});
+		mapped_source(const mapped_source&) = delete;
+		mapped_source(mapped_source&& other) noexcept;
+		auto operator=(const mapped_source&) -> mapped_source& = delete;
+		auto operator=(mapped_source&& other) noexcept -> mapped_source&;
+		~mapped_source() noexcept;
+
+		[[nodiscard]] auto data() const noexcept -> const char*;
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		// views of the whole file, unfiltered or through pred
+		[[nodiscard]] auto view() const noexcept -> filtered_string_view;
+		template<typename Pred>
+		[[nodiscard]] auto view(Pred pred) const noexcept -> basic_filtered_string_view<Pred> {
+			return basic_filtered_string_view<Pred>{data_, data_ + size_, std::move(pred)};
+		}
+
+	 private:
+		void unmap() noexcept;
+
+		const char* data_ = nullptr;
+		std::size_t size_ = 0;
+	};
+} // namespace fsv
+
+#endif // COMP6771_ASS2_MAPPED_SOURCE_H
@@ -0,0 +1,114 @@
+#include "./mapped_source.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace {
+	// a file holding contents, removed again at the end of the test
+	class temp_path {
+	 public:
+		explicit temp_path(const std::string& contents) {
+			auto pattern = std::string{"/tmp/mapped_source_test.XXXXXX"};
+			const int fd = ::mkstemp(pattern.data());
+			REQUIRE(fd >= 0);
+			::close(fd);
+			path_ = pattern;
+			std::ofstream{path_, std::ios::binary} << contents;
+		}
+		temp_path(const temp_path&) = delete;
+		auto operator=(const temp_path&) -> temp_path& = delete;
+		~temp_path() {
+			::unlink(path_.c_str());
+		}
+
+		[[nodiscard]] auto path() const -> const std::string& {
+			return path_;
+		}
+
+	 private:
+		std::string path_;
+	};
+} // namespace
+
+TEST_CASE("mapped_source views the whole file") {
+	auto contents = std::string{};
+	for (int i = 0; i < 10000; ++i) {
+		contents += "line " + std::to_string(i) + "\n";
+	}
+	const auto file = temp_path{contents};
+	const auto source = fsv::mapped_source{file.path(), {.sequential = true, .huge_pages = true, .populate = true}};
+	REQUIRE(source.size() == contents.size());
+
+	const auto whole = source.view();
+	CHECK(whole.size() == contents.size());
+	CHECK(static_cast<std::string>(whole) == contents);
+
+	const auto digits = source.view(fsv::range('0', '9'));
+	CHECK(digits.size() == 38890);
+	CHECK(fsv::split(whole, fsv::filtered_string_view{"\n"}).size() == 10001);
+}
+
+TEST_CASE("mapped_source of an empty file is an empty view") {
+	const auto file = temp_path{""};
+	const auto source = fsv::mapped_source{file.path()};
+	CHECK(source.size() == 0);
+	CHECK(source.view().empty());
+}
+
+TEST_CASE("mapped_source moves ownership of the mapping") {
+	const auto file = temp_path{"akita"};
+	auto source = fsv::mapped_source{file.path()};
+	const char* data = source.data();
+	auto moved = std::move(source);
+	CHECK(moved.data() == data);
+	CHECK(source.data() == nullptr);
+	CHECK(static_cast<std::string>(moved.view()) == "akita");
+
+	source = std::move(moved);
+	CHECK(source.data() == data);
+}
+
+TEST_CASE("mapped_source reports missing files") {
+	REQUIRE_THROWS_AS(fsv::mapped_source{"/nonexistent/mapped_source_test"}, std::system_error);
+}
+
+TEST_CASE("views over a mapping larger than 4 GB index past 32 bits") {
+	if constexpr (sizeof(void*) < 8) {
+		return;
+	}
+	constexpr auto length = std::size_t{5} << 30;
+	constexpr auto far = (std::size_t{9} << 29) + 7;
+	auto pattern = std::string{"/tmp/mapped_source_test.XXXXXX"};
+	const int fd = ::mkstemp(pattern.data());
+	REQUIRE(fd >= 0);
+	::unlink(pattern.c_str());
+	// a sparse file: only the page holding the marker is ever allocated or read
+	const bool sparse = ::ftruncate(fd, static_cast<off_t>(length)) == 0
+	                    and ::pwrite(fd, "far", 3, static_cast<off_t>(far)) == 3;
+	const auto path = "/proc/self/fd/" + std::to_string(fd);
+	if (not sparse) {
+		::close(fd);
+		WARN("cannot create a sparse 5 GB file, skipping");
+		return;
+	}
+	const auto source = fsv::mapped_source{path, {.sequential = false, .huge_pages = false, .populate = false}};
+	::close(fd);
+
+	const auto whole = source.view();
+	REQUIRE(whole.size() == length);
+	CHECK(whole.at(far) == 'f');
+	CHECK(whole[far + 2] == 'r');
+	CHECK(static_cast<std::string>(fsv::substr(whole, far, std::size_t{3})) == "far");
+	REQUIRE_THROWS_AS(whole.at(length), std::domain_error);
+
+	// only the bytes from the marker on are filtered, so nothing else is touched
+	const char* marker = source.data() + far;
+	const auto tail = fsv::basic_filtered_string_view{marker, marker + 3, fsv::range('a', 'f')};
+	CHECK(static_cast<std::string>(tail) == "fa");
+}
@@ -0,0 +1,78 @@
+#include "./predicates.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+
+namespace fsv {
+	filter_chain::filter_chain(const std::vector<filter>& filts)
+	: table_{char_class::all()} {
+		for (std::size_t i = 0; i < filts.size(); ++i) {
+			if (const auto* cls = detail::table_of(filts[i]); cls != nullptr) {
+				table_ = table_ & *cls;
+			}
+			else {
+				filts_.push_back(filts[i]);
+				order_.push_back(i);
+			}
+		}
+	}
+
+	auto filter_chain::operator()(const char& c) const -> bool {
+		if (not table_(c)) {
+			return false;
+		}
+		for (const auto& filt : filts_) {
+			if (!filt(c)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void filter_chain::adapt(const char* sample, std::size_t length) {
+		if (filts_.size() < 2 or length == 0) {
+			return;
+		}
+		// expected cost of running a filter divided by its chance of ending the chain; lower goes first
+		auto score = std::vector<double>(filts_.size());
+		for (std::size_t f = 0; f < filts_.size(); ++f) {
+			std::size_t rejected = 0;
+			const auto start = std::chrono::steady_clock::now();
+			for (std::size_t i = 0; i < length; ++i) {
+				rejected += static_cast<std::size_t>(not filts_[f](sample[i]));
+			}
+			const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+			score[f] = (rejected == 0) ? std::numeric_limits<double>::infinity()
+			                           : elapsed.count() / static_cast<double>(rejected);
+		}
+
+		auto rank = std::vector<std::size_t>(filts_.size());
+		std::iota(rank.begin(), rank.end(), std::size_t{0});
+		std::stable_sort(rank.begin(), rank.end(), [&score](std::size_t lhs, std::size_t rhs) {
+			return score[lhs] < score[rhs];
+		});
+
+		auto filts = std::vector<filter>{};
+		auto order = std::vector<std::size_t>{};
+		for (auto f : rank) {
+			filts.push_back(std::move(filts_[f]));
+			order.push_back(order_[f]);
+		}
+		filts_ = std::move(filts);
+		order_ = std::move(order);
+	}
+
+	auto filter_chain::table() const noexcept -> const char_class& {
+		return table_;
+	}
+
+	auto filter_chain::filters() const noexcept -> const std::vector<filter>& {
+		return filts_;
+	}
+
+	auto filter_chain::order() const noexcept -> const std::vector<std::size_t>& {
+		return order_;
+	}
+} // namespace fsv
@@ -0,0 +1,156 @@
+#ifndef COMP6771_ASS2_PREDICATES_H
+#define COMP6771_ASS2_PREDICATES_H
+
+#include "./char_class.h"
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fsv {
+	using filter = std::function<bool(const char&)>;
+
+	// Predicate combinators. Whenever every operand is a char_class the result is folded into a single char_class, so
+	// the combined predicate costs one table lookup and can use the SIMD kernels. Otherwise the operands are fused into
+	// one callable whose body inlines each of them, rather than one type-erased call per operand.
+
+	// byte values from first to last inclusive, compared as unsigned char
+	[[nodiscard]] constexpr auto range(char first, char last) noexcept -> char_class {
+		auto soln = char_class{};
+		const auto lo = static_cast<unsigned char>(first);
+		const auto hi = static_cast<unsigned char>(last);
+		for (unsigned b = lo; b <= hi; ++b) {
+			soln.insert(static_cast<unsigned char>(b));
+		}
+		return soln;
+	}
+
+	// The predicate that accepts every character. A view filtered by it, directly or through a std::function,
+	// inline_filter or filter_ref, is recognised as unfiltered and reads its buffer as plain bytes.
+	struct accept_all {
+		[[nodiscard]] constexpr auto operator()(const char&) const noexcept -> bool {
+			return true;
+		}
+	};
+
+	// the characters of members
+	[[nodiscard]] constexpr auto set(std::string_view members) noexcept -> char_class {
+		auto soln = char_class{};
+		for (auto c : members) {
+			soln.insert(static_cast<unsigned char>(c));
+		}
+		return soln;
+	}
+
+	namespace detail {
+		// What a view made without a predicate is given. Pred is built from accept_all itself, so an inline_filter or
+		// filter_ref holds it directly rather than through another wrapper; static storage keeps a filter_ref to it
+		// valid.
+		inline constexpr accept_all accept_everything{};
+
+		// whether the predicate is known to be accept_all, statically or as the target of a type-erased holder
+		template<typename Pred>
+		[[nodiscard]] constexpr auto is_accept_all(const Pred&) noexcept -> bool {
+			return std::is_same_v<Pred, accept_all>;
+		}
+
+		[[nodiscard]] inline auto is_accept_all(const filter& predicate) noexcept -> bool {
+			return predicate.target<accept_all>() != nullptr;
+		}
+
+		template<typename... Preds>
+		inline constexpr bool all_tables = (std::is_same_v<std::remove_cvref_t<Preds>, char_class> and ...);
+
+		template<typename... Preds>
+		struct all_of_fn {
+			std::tuple<Preds...> preds;
+
+			[[nodiscard]] constexpr auto operator()(const char& c) const -> bool {
+				return std::apply([&c](const auto&... pred) { return (static_cast<bool>(pred(c)) and ...); }, preds);
+			}
+		};
+
+		template<typename... Preds>
+		struct any_of_fn {
+			std::tuple<Preds...> preds;
+
+			[[nodiscard]] constexpr auto operator()(const char& c) const -> bool {
+				return std::apply([&c](const auto&... pred) { return (static_cast<bool>(pred(c)) or ...); }, preds);
+			}
+		};
+
+		template<typename Pred>
+		struct not_fn {
+			Pred pred;
+
+			[[nodiscard]] constexpr auto operator()(const char& c) const -> bool {
+				return not static_cast<bool>(pred(c));
+			}
+		};
+	} // namespace detail
+
+	// accepts a character when every operand does; operands are evaluated left to right and short-circuit
+	template<typename... Preds>
+	[[nodiscard]] constexpr auto all_of(Preds&&... preds) {
+		if constexpr (detail::all_tables<Preds...>) {
+			return (char_class::all() & ... & preds);
+		}
+		else {
+			return detail::all_of_fn<std::decay_t<Preds>...>{{std::forward<Preds>(preds)...}};
+		}
+	}
+
+	// accepts a character when any operand does; operands are evaluated left to right and short-circuit
+	template<typename... Preds>
+	[[nodiscard]] constexpr auto any_of(Preds&&... preds) {
+		if constexpr (detail::all_tables<Preds...>) {
+			return (char_class{} | ... | preds);
+		}
+		else {
+			return detail::any_of_fn<std::decay_t<Preds>...>{{std::forward<Preds>(preds)...}};
+		}
+	}
+
+	template<typename Pred>
+	[[nodiscard]] constexpr auto not_(Pred&& pred) {
+		if constexpr (detail::all_tables<Pred>) {
+			return ~pred;
+		}
+		else {
+			return detail::not_fn<std::decay_t<Pred>>{std::forward<Pred>(pred)};
+		}
+	}
+
+	// The conjunction of a list of filters, as built by compose(). Filters that are char_class tables are intersected
+	// into one table that is tested first; the rest stay opaque and are called in order(), short-circuiting on the
+	// first rejection.
+	class filter_chain {
+	 public:
+		explicit filter_chain(const std::vector<filter>& filts);
+
+		[[nodiscard]] auto operator()(const char& c) const -> bool;
+
+		// Calls every opaque filter on each byte of the sample, then reorders them by measured cost per rejection so
+		// that cheap filters which reject often run first. Filters that reject nothing in the sample run last, and
+		// ties keep their original order.
+		void adapt(const char* sample, std::size_t length);
+
+		// the intersection of the table filters, char_class::all() if there were none
+		[[nodiscard]] auto table() const noexcept -> const char_class&;
+		// the opaque filters, in evaluation order
+		[[nodiscard]] auto filters() const noexcept -> const std::vector<filter>&;
+		// the position in the original list of each opaque filter, in evaluation order
+		[[nodiscard]] auto order() const noexcept -> const std::vector<std::size_t>&;
+
+	 private:
+		char_class table_;
+		std::vector<filter> filts_;
+		std::vector<std::size_t> order_;
+	};
+} // namespace fsv
+
+#endif // COMP6771_ASS2_PREDICATES_H
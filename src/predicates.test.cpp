@@ -0,0 +1,104 @@
+#include "./predicates.h"
+
+#include <catch2/catch.hpp>
+
+#include <functional>
+#include <string>
+
+TEST_CASE("range() and set()") {
+	constexpr auto lower = fsv::range('a', 'z');
+	STATIC_REQUIRE(lower.count() == 26);
+	STATIC_REQUIRE(lower('q'));
+	STATIC_REQUIRE(not lower('Q'));
+
+	constexpr auto vowels = fsv::set("aeiou");
+	STATIC_REQUIRE(vowels.count() == 5);
+	STATIC_REQUIRE(vowels('e'));
+	STATIC_REQUIRE(not vowels('z'));
+
+	STATIC_REQUIRE(fsv::range('z', 'a').count() == 0);
+	STATIC_REQUIRE(fsv::range('\0', static_cast<char>(0xff)) == fsv::char_class::all());
+}
+
+TEST_CASE("combinators over tables fold into one table") {
+	constexpr auto consonant = fsv::all_of(fsv::range('a', 'z'), fsv::not_(fsv::set("aeiou")));
+	STATIC_REQUIRE(std::is_same_v<std::remove_const_t<decltype(consonant)>, fsv::char_class>);
+	STATIC_REQUIRE(consonant.count() == 21);
+
+	constexpr auto alnum = fsv::any_of(fsv::range('a', 'z'), fsv::range('A', 'Z'), fsv::range('0', '9'));
+	STATIC_REQUIRE(std::is_same_v<std::remove_const_t<decltype(alnum)>, fsv::char_class>);
+	STATIC_REQUIRE(alnum.count() == 62);
+}
+
+TEST_CASE("combinators over other callables fuse into one callable") {
+	auto is_odd = [](const char& c) { return (c & 1) != 0; };
+	auto odd_digit = fsv::all_of(fsv::range('0', '9'), is_odd);
+	REQUIRE(odd_digit('3'));
+	REQUIRE_FALSE(odd_digit('4'));
+	REQUIRE_FALSE(odd_digit('a'));
+
+	auto odd_or_space = fsv::any_of(is_odd, std::function<bool(const char&)>{[](const char& c) { return c == ' '; }});
+	REQUIRE(odd_or_space(' '));
+	REQUIRE(odd_or_space('a'));
+	REQUIRE_FALSE(odd_or_space('b'));
+
+	auto even = fsv::not_(is_odd);
+	REQUIRE(even('b'));
+	REQUIRE_FALSE(even('a'));
+}
+
+TEST_CASE("all_of() short-circuits left to right") {
+	auto calls = 0;
+	auto counted = [&calls](const char&) {
+		++calls;
+		return true;
+	};
+	auto pred = fsv::all_of([](const char& c) { return c == 'x'; }, counted);
+	REQUIRE_FALSE(pred('y'));
+	REQUIRE(calls == 0);
+	REQUIRE(pred('x'));
+	REQUIRE(calls == 1);
+}
+
+TEST_CASE("filter_chain folds tables and keeps opaque filters in order") {
+	auto odd = fsv::filter{[](const char& c) { return (c & 1) != 0; }};
+	auto not_q = fsv::filter{[](const char& c) { return c != 'q'; }};
+	auto chain = fsv::filter_chain{{odd, fsv::range('a', 'z'), not_q, fsv::not_(fsv::set("aeiou"))}};
+	REQUIRE(chain.table() == fsv::all_of(fsv::range('a', 'z'), fsv::not_(fsv::set("aeiou"))));
+	REQUIRE(chain.filters().size() == 2);
+	REQUIRE(chain.order() == std::vector<std::size_t>{0, 2});
+	REQUIRE(chain('c'));
+	REQUIRE_FALSE(chain('a'));
+	REQUIRE_FALSE(chain('q'));
+	REQUIRE_FALSE(chain('b'));
+	REQUIRE_FALSE(chain('C'));
+}
+
+TEST_CASE("filter_chain::adapt() runs the rejecting filter first") {
+	auto sample = std::string(4096, 'a');
+	auto keeps_everything = fsv::filter{[](const char&) { return true; }};
+	auto rejects_a = fsv::filter{[](const char& c) { return c != 'a'; }};
+	auto chain = fsv::filter_chain{{keeps_everything, keeps_everything, rejects_a}};
+	chain.adapt(sample.data(), sample.size());
+	REQUIRE(chain.order() == std::vector<std::size_t>{2, 0, 1});
+	REQUIRE_FALSE(chain('a'));
+	REQUIRE(chain('b'));
+}
+
+TEST_CASE("filter_chain::adapt() prefers the cheaper of two equally selective filters") {
+	auto sample = std::string(4096, 'a');
+	for (std::size_t i = 0; i < sample.size(); i += 2) {
+		sample[i] = 'b';
+	}
+	auto expensive = fsv::filter{[](const char& c) {
+		auto volatile acc = 0u;
+		for (auto i = 0u; i < 2000u; ++i) {
+			acc = acc + static_cast<unsigned>(c);
+		}
+		return c != 'a';
+	}};
+	auto cheap = fsv::filter{[](const char& c) { return c != 'a'; }};
+	auto chain = fsv::filter_chain{{expensive, cheap}};
+	chain.adapt(sample.data(), sample.size());
+	REQUIRE(chain.order() == std::vector<std::size_t>{1, 0});
+}
@@ -0,0 +1,156 @@
+#include "./rank_select.h"
+#include "./scan_kernels.h"
+
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <utility>
+
+namespace fsv::detail {
+	namespace {
+		// position of the r-th set bit of a word, requires r < popcount(word)
+		auto select_in_word(std::uint64_t word, std::size_t r) noexcept -> std::size_t {
+			std::size_t offset = 0;
+			for (;;) {
+				auto in_byte = static_cast<std::size_t>(std::popcount(word & 0xffu));
+				if (r < in_byte) {
+					break;
+				}
+				r -= in_byte;
+				word >>= 8;
+				offset += 8;
+			}
+			for (; r > 0; --r) {
+				word &= word - 1;
+			}
+			return offset + static_cast<std::size_t>(std::countr_zero(word));
+		}
+	} // namespace
+
+	rank_select::rank_select(const char* ptr, std::size_t length, const char_class& cls)
+	: length_{length}
+	, count_{0}
+	, words_((length + word_bits - 1) / word_bits, 0) {
+		simd::active().classify(cls, ptr, length, words_.data());
+		build_directory();
+	}
+
+	void rank_select::build_directory() {
+		superblocks_.reserve(words_.size() / superblock_words + 2);
+		std::size_t running = 0;
+		for (std::size_t w = 0; w < words_.size(); ++w) {
+			if (w % superblock_words == 0) {
+				superblocks_.push_back(running);
+			}
+			auto in_word = static_cast<std::size_t>(std::popcount(words_[w]));
+			while (select_samples_.size() * select_sample_rate < running + in_word) {
+				select_samples_.push_back(w / superblock_words);
+			}
+			running += in_word;
+		}
+		// sentinel so that rank(length()) and the upper bound in select() never need a special case
+		superblocks_.push_back(running);
+		count_ = running;
+	}
+
+	auto rank_select::rank(std::size_t pos) const noexcept -> std::size_t {
+		const std::size_t w = pos / word_bits;
+		const std::size_t sb = w / superblock_words;
+		auto soln = static_cast<std::size_t>(superblocks_[sb]);
+		for (std::size_t i = sb * superblock_words; i < w; ++i) {
+			soln += static_cast<std::size_t>(std::popcount(words_[i]));
+		}
+		if (pos % word_bits != 0) {
+			const auto mask = (std::uint64_t{1} << (pos % word_bits)) - 1;
+			soln += static_cast<std::size_t>(std::popcount(words_[w] & mask));
+		}
+		return soln;
+	}
+
+	auto rank_select::select(std::size_t k) const noexcept -> std::size_t {
+		const std::size_t sample = k / select_sample_rate;
+		const std::size_t last_superblock = superblocks_.size() - 2;
+		const std::size_t lo = select_samples_[sample];
+		const std::size_t hi = (sample + 1 < select_samples_.size()) ? select_samples_[sample + 1] : last_superblock;
+		auto first = superblocks_.begin() + static_cast<std::ptrdiff_t>(lo);
+		auto last = superblocks_.begin() + static_cast<std::ptrdiff_t>(hi) + 1;
+		auto sb = static_cast<std::size_t>(std::upper_bound(first, last, k) - superblocks_.begin()) - 1;
+
+		auto r = k - static_cast<std::size_t>(superblocks_[sb]);
+		std::size_t w = sb * superblock_words;
+		for (;; ++w) {
+			auto in_word = static_cast<std::size_t>(std::popcount(words_[w]));
+			if (r < in_word) {
+				break;
+			}
+			r -= in_word;
+		}
+		return w * word_bits + select_in_word(words_[w], r);
+	}
+
+	auto rank_select::count() const noexcept -> std::size_t {
+		return count_;
+	}
+
+	auto rank_select::length() const noexcept -> std::size_t {
+		return length_;
+	}
+
+	struct index_cache::node {
+		rank_select index;
+		std::atomic<std::size_t> refs;
+	};
+
+	index_cache::index_cache(const index_cache& other) noexcept
+	: node_{other.acquire()} {}
+
+	index_cache::index_cache(index_cache&& other) noexcept
+	: node_{other.node_.exchange(nullptr, std::memory_order_acq_rel)} {}
+
+	auto index_cache::operator=(const index_cache& other) noexcept -> index_cache& {
+		if (this != &other) {
+			release(node_.exchange(other.acquire(), std::memory_order_acq_rel));
+		}
+		return *this;
+	}
+
+	auto index_cache::operator=(index_cache&& other) noexcept -> index_cache& {
+		if (this != &other) {
+			release(node_.exchange(other.node_.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_acq_rel));
+		}
+		return *this;
+	}
+
+	index_cache::~index_cache() {
+		release(node_.load(std::memory_order_acquire));
+	}
+
+	auto index_cache::get() const noexcept -> const rank_select* {
+		const auto* n = node_.load(std::memory_order_acquire);
+		return n == nullptr ? nullptr : &n->index;
+	}
+
+	auto index_cache::publish(rank_select built) const -> const rank_select& {
+		auto fresh = std::make_unique<node>(std::move(built), 1);
+		node* expected = nullptr;
+		if (node_.compare_exchange_strong(expected, fresh.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			return fresh.release()->index;
+		}
+		return expected->index;
+	}
+
+	// a new reference to the published node, which only a non-const member of its owner can release meanwhile
+	auto index_cache::acquire() const noexcept -> node* {
+		auto* n = node_.load(std::memory_order_acquire);
+		if (n != nullptr) {
+			n->refs.fetch_add(1, std::memory_order_relaxed);
+		}
+		return n;
+	}
+
+	void index_cache::release(node* n) noexcept {
+		if (n != nullptr and n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete n;
+		}
+	}
+} // namespace fsv::detail
@@ -0,0 +1,89 @@
+#ifndef COMP6771_ASS2_RANK_SELECT_H
+#define COMP6771_ASS2_RANK_SELECT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fsv {
+	class char_class;
+} // namespace fsv
+
+namespace fsv::detail {
+	// Succinct index over the bytes of a buffer accepted by a predicate. One bit per raw byte, a cumulative popcount
+	// per 512-bit superblock for rank(), and the superblock of every 512th set bit as a starting hint for select().
+	class rank_select {
+	 public:
+		static constexpr std::size_t word_bits = 64;
+		static constexpr std::size_t superblock_words = 8;
+		static constexpr std::size_t superblock_bits = word_bits * superblock_words;
+		static constexpr std::size_t select_sample_rate = 512;
+
+		template<typename Pred>
+		rank_select(const char* ptr, std::size_t length, const Pred& pred);
+		// classifies the buffer with the SIMD table kernels
+		rank_select(const char* ptr, std::size_t length, const char_class& cls);
+
+		// number of accepted bytes in [0, pos)
+		[[nodiscard]] auto rank(std::size_t pos) const noexcept -> std::size_t;
+		// raw position of the k-th accepted byte, requires k < count()
+		[[nodiscard]] auto select(std::size_t k) const noexcept -> std::size_t;
+		[[nodiscard]] auto count() const noexcept -> std::size_t;
+		[[nodiscard]] auto length() const noexcept -> std::size_t;
+
+	 private:
+		void build_directory();
+
+		std::size_t length_;
+		std::size_t count_;
+		std::vector<std::uint64_t> words_;
+		std::vector<std::uint64_t> superblocks_;
+		std::vector<std::size_t> select_samples_;
+	};
+
+	// The lazily built index of a view, shared by reference count with the view's copies. It is published with a
+	// compare-and-swap, so const members of one view may build it from several threads at once; the first index
+	// published is kept and the others are discarded.
+	class index_cache {
+	 public:
+		index_cache() noexcept = default;
+		index_cache(const index_cache& other) noexcept;
+		index_cache(index_cache&& other) noexcept;
+		auto operator=(const index_cache& other) noexcept -> index_cache&;
+		auto operator=(index_cache&& other) noexcept -> index_cache&;
+		~index_cache();
+
+		// the published index, or nullptr if there is none yet
+		[[nodiscard]] auto get() const noexcept -> const rank_select*;
+		// publishes built unless another index was published first, and returns the one that was
+		auto publish(rank_select built) const -> const rank_select&;
+
+	 private:
+		struct node;
+
+		[[nodiscard]] auto acquire() const noexcept -> node*;
+		static void release(node* n) noexcept;
+
+		mutable std::atomic<node*> node_ = nullptr;
+	};
+
+	template<typename Pred>
+	rank_select::rank_select(const char* ptr, std::size_t length, const Pred& pred)
+	: length_{length}
+	, count_{0}
+	, words_((length + word_bits - 1) / word_bits, 0) {
+		for (std::size_t w = 0; w < words_.size(); ++w) {
+			const std::size_t first = w * word_bits;
+			const std::size_t last = (first + word_bits < length) ? first + word_bits : length;
+			std::uint64_t bits = 0;
+			for (std::size_t i = first; i < last; ++i) {
+				bits |= static_cast<std::uint64_t>(pred(ptr[i]) ? 1 : 0) << (i - first);
+			}
+			words_[w] = bits;
+		}
+		build_directory();
+	}
+} // namespace fsv::detail
+
+#endif // COMP6771_ASS2_RANK_SELECT_H
@@ -0,0 +1,76 @@
+#include "./rank_select.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+namespace {
+	auto make_buffer(std::size_t length, std::size_t stride) -> std::string {
+		auto soln = std::string(length, '.');
+		for (std::size_t i = 0; i < length; i += stride) {
+			soln[i] = 'x';
+		}
+		return soln;
+	}
+
+	auto is_x = [](const char& c) { return c == 'x'; };
+} // namespace
+
+TEST_CASE("rank_select on an empty buffer") {
+	auto idx = fsv::detail::rank_select{nullptr, 0, is_x};
+	REQUIRE(idx.count() == 0);
+	REQUIRE(idx.rank(0) == 0);
+}
+
+TEST_CASE("rank_select agrees with a linear scan") {
+	for (std::size_t stride : {1u, 2u, 7u, 63u, 64u, 65u, 511u, 512u, 513u, 4099u}) {
+		auto buffer = make_buffer(20000, stride);
+		auto idx = fsv::detail::rank_select{buffer.data(), buffer.size(), is_x};
+
+		std::size_t seen = 0;
+		for (std::size_t i = 0; i < buffer.size(); ++i) {
+			REQUIRE(idx.rank(i) == seen);
+			if (is_x(buffer[i])) {
+				REQUIRE(idx.select(seen) == i);
+				++seen;
+			}
+		}
+		REQUIRE(idx.rank(buffer.size()) == seen);
+		REQUIRE(idx.count() == seen);
+	}
+}
+
+TEST_CASE("rank_select with long gaps between accepted bytes") {
+	auto buffer = std::string(100000, '.');
+	buffer[3] = 'x';
+	buffer[70000] = 'x';
+	buffer[99999] = 'x';
+	auto idx = fsv::detail::rank_select{buffer.data(), buffer.size(), is_x};
+	REQUIRE(idx.count() == 3);
+	REQUIRE(idx.select(0) == 3);
+	REQUIRE(idx.select(1) == 70000);
+	REQUIRE(idx.select(2) == 99999);
+	REQUIRE(idx.rank(70000) == 1);
+	REQUIRE(idx.rank(70001) == 2);
+}
+
+TEST_CASE("index_cache keeps the first index published and shares it with copies") {
+	auto buffer = make_buffer(1000, 3);
+	auto cache = fsv::detail::index_cache{};
+	REQUIRE(cache.get() == nullptr);
+
+	const auto& first = cache.publish(fsv::detail::rank_select{buffer.data(), buffer.size(), is_x});
+	const auto& second = cache.publish(fsv::detail::rank_select{buffer.data(), 10, is_x});
+	REQUIRE(&second == &first);
+	REQUIRE(cache.get() == &first);
+	REQUIRE(first.count() == 334);
+
+	auto copy = cache;
+	REQUIRE(copy.get() == &first);
+	cache = fsv::detail::index_cache{};
+	REQUIRE(cache.get() == nullptr);
+	REQUIRE(copy.get()->count() == 334);
+
+	auto moved = std::move(copy);
+	REQUIRE(moved.get() == &first);
+}
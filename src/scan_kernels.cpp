@@ -0,0 +1,339 @@
+#include "./scan_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#	include <immintrin.h>
+#endif
+
+namespace fsv::detail::simd {
+	namespace {
+		auto count_scalar(const char_class& cls, const char* ptr, std::size_t length) noexcept -> std::size_t {
+			std::size_t soln = 0;
+			for (std::size_t i = 0; i < length; ++i) {
+				soln += static_cast<std::size_t>(cls(ptr[i]));
+			}
+			return soln;
+		}
+
+		auto compact_scalar(const char_class& cls,
+		                    const char* ptr,
+		                    std::size_t length,
+		                    char* out,
+		                    std::size_t capacity) noexcept -> std::size_t {
+			std::size_t soln = 0;
+			for (std::size_t i = 0; i < length and soln < capacity; ++i) {
+				out[soln] = ptr[i];
+				soln += static_cast<std::size_t>(cls(ptr[i]));
+			}
+			return soln;
+		}
+
+		void
+		classify_scalar(const char_class& cls, const char* ptr, std::size_t length, std::uint64_t* words) noexcept {
+			for (std::size_t first = 0; first < length; first += 64) {
+				const std::size_t last = std::min(first + 64, length);
+				std::uint64_t word = 0;
+				for (std::size_t i = first; i < last; ++i) {
+					word |= static_cast<std::uint64_t>(cls(ptr[i])) << (i - first);
+				}
+				words[first / 64] = word;
+			}
+		}
+
+		constexpr auto scalar_kernels = kernels{count_scalar, compact_scalar, classify_scalar};
+
+#if defined(__x86_64__) || defined(__i386__)
+		// For each 8-bit mask, the pshufb indices that gather the selected bytes of an 8-byte group to its front.
+		constexpr auto compress_table = [] {
+			auto soln = std::array<std::uint64_t, 256>{};
+			for (std::size_t mask = 0; mask < soln.size(); ++mask) {
+				std::size_t out = 0;
+				for (std::uint64_t bit = 0; bit < 8; ++bit) {
+					if ((mask >> bit & 1) != 0) {
+						soln[mask] |= bit << (8 * out++);
+					}
+				}
+			}
+			return soln;
+		}();
+
+		// Membership test of 16 bytes at once (Mula's universal pshufb lookup): the low nibble picks a row from
+		// either half of the table, the sign bit of the byte picks the half, and the high nibble picks the bit.
+		[[gnu::target("sse4.2")]] inline auto
+		lookup16(__m128i v, __m128i rows_lo, __m128i rows_hi, __m128i bit_of) noexcept -> std::uint32_t {
+			const auto nibble = _mm_set1_epi8(0x0f);
+			const auto lo = _mm_and_si128(v, nibble);
+			const auto hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+			const auto row = _mm_blendv_epi8(_mm_shuffle_epi8(rows_lo, lo), _mm_shuffle_epi8(rows_hi, lo), v);
+			const auto bit = _mm_shuffle_epi8(bit_of, hi);
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit)));
+		}
+
+		[[gnu::target("avx2")]] inline auto
+		lookup32(__m256i v, __m256i rows_lo, __m256i rows_hi, __m256i bit_of) noexcept -> std::uint32_t {
+			const auto nibble = _mm256_set1_epi8(0x0f);
+			const auto lo = _mm256_and_si256(v, nibble);
+			const auto hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+			const auto row = _mm256_blendv_epi8(_mm256_shuffle_epi8(rows_lo, lo), _mm256_shuffle_epi8(rows_hi, lo), v);
+			const auto bit = _mm256_shuffle_epi8(bit_of, hi);
+			return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)));
+		}
+
+		// the bit a high nibble selects within a table row
+		[[gnu::target("sse4.2")]] inline auto bit_of_nibble128() noexcept -> __m128i {
+			return _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+		}
+
+		// half 0 holds the rows for bytes below 0x80, half 1 the rows for the rest
+		[[gnu::target("sse4.2")]] inline auto rows128(const char_class& cls, std::size_t half) noexcept -> __m128i {
+			return _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.rows().data() + 16 * half));
+		}
+
+		[[gnu::target("avx2")]] inline auto rows256(const char_class& cls, std::size_t half) noexcept -> __m256i {
+			return _mm256_broadcastsi128_si256(rows128(cls, half));
+		}
+
+		// Packs the bytes of a 16-byte vector selected by mask to the front of out and returns how many there were.
+		// The two 8-byte stores always touch 16 bytes of out, whatever the mask.
+		[[gnu::target("sse4.2,popcnt")]] inline auto compress16(__m128i v, std::uint32_t mask, char* out) noexcept
+		    -> std::size_t {
+			const auto lo_mask = mask & 0xffu;
+			const auto hi_mask = mask >> 8 & 0xffu;
+			const auto indices = _mm_set_epi64x(static_cast<long long>(compress_table[hi_mask] + 0x0808080808080808u),
+			                                    static_cast<long long>(compress_table[lo_mask]));
+			const auto packed = _mm_shuffle_epi8(v, indices);
+			const auto lo_count = static_cast<std::size_t>(std::popcount(lo_mask));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + lo_count), _mm_srli_si128(packed, 8));
+			return lo_count + static_cast<std::size_t>(std::popcount(hi_mask));
+		}
+
+		[[gnu::target("sse4.2,popcnt")]] auto
+		count_sse42(const char_class& cls, const char* ptr, std::size_t length) noexcept -> std::size_t {
+			const auto rows_lo = rows128(cls, 0);
+			const auto rows_hi = rows128(cls, 1);
+			const auto bit_of = bit_of_nibble128();
+			std::size_t soln = 0;
+			std::size_t i = 0;
+			for (; i + 16 <= length; i += 16) {
+				const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+				soln += static_cast<std::size_t>(std::popcount(lookup16(v, rows_lo, rows_hi, bit_of)));
+			}
+			return soln + count_scalar(cls, ptr + i, length - i);
+		}
+
+		[[gnu::target("sse4.2,popcnt")]] auto
+		compact_sse42(const char_class& cls,
+		              const char* ptr,
+		              std::size_t length,
+		              char* out,
+		              std::size_t capacity) noexcept -> std::size_t {
+			const auto rows_lo = rows128(cls, 0);
+			const auto rows_hi = rows128(cls, 1);
+			const auto bit_of = bit_of_nibble128();
+			std::size_t soln = 0;
+			std::size_t i = 0;
+			for (; i + 16 <= length and capacity - soln >= 16; i += 16) {
+				const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+				soln += compress16(v, lookup16(v, rows_lo, rows_hi, bit_of), out + soln);
+			}
+			return soln + compact_scalar(cls, ptr + i, length - i, out + soln, capacity - soln);
+		}
+
+		[[gnu::target("sse4.2")]] void
+		classify_sse42(const char_class& cls, const char* ptr, std::size_t length, std::uint64_t* words) noexcept {
+			const auto rows_lo = rows128(cls, 0);
+			const auto rows_hi = rows128(cls, 1);
+			const auto bit_of = bit_of_nibble128();
+			std::size_t i = 0;
+			for (; i + 64 <= length; i += 64) {
+				std::uint64_t word = 0;
+				for (std::size_t part = 0; part < 4; ++part) {
+					const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i + 16 * part));
+					word |= static_cast<std::uint64_t>(lookup16(v, rows_lo, rows_hi, bit_of)) << (16 * part);
+				}
+				words[i / 64] = word;
+			}
+			classify_scalar(cls, ptr + i, length - i, words + i / 64);
+		}
+
+		constexpr auto sse42_kernels = kernels{count_sse42, compact_sse42, classify_sse42};
+
+		[[gnu::target("avx2,popcnt")]] auto
+		count_avx2(const char_class& cls, const char* ptr, std::size_t length) noexcept -> std::size_t {
+			const auto rows_lo = rows256(cls, 0);
+			const auto rows_hi = rows256(cls, 1);
+			const auto bit_of = _mm256_broadcastsi128_si256(bit_of_nibble128());
+			std::size_t soln = 0;
+			std::size_t i = 0;
+			for (; i + 32 <= length; i += 32) {
+				const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+				soln += static_cast<std::size_t>(std::popcount(lookup32(v, rows_lo, rows_hi, bit_of)));
+			}
+			return soln + count_scalar(cls, ptr + i, length - i);
+		}
+
+		[[gnu::target("avx2,popcnt")]] auto
+		compact_avx2(const char_class& cls,
+		             const char* ptr,
+		             std::size_t length,
+		             char* out,
+		             std::size_t capacity) noexcept -> std::size_t {
+			const auto rows_lo = rows256(cls, 0);
+			const auto rows_hi = rows256(cls, 1);
+			const auto bit_of = _mm256_broadcastsi128_si256(bit_of_nibble128());
+			std::size_t soln = 0;
+			std::size_t i = 0;
+			for (; i + 32 <= length and capacity - soln >= 32; i += 32) {
+				const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+				const auto mask = lookup32(v, rows_lo, rows_hi, bit_of);
+				if (mask == 0xffffffffu) {
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + soln), v);
+					soln += 32;
+				}
+				else if (mask != 0) {
+					soln += compress16(_mm256_castsi256_si128(v), mask & 0xffffu, out + soln);
+					soln += compress16(_mm256_extracti128_si256(v, 1), mask >> 16, out + soln);
+				}
+			}
+			return soln + compact_scalar(cls, ptr + i, length - i, out + soln, capacity - soln);
+		}
+
+		[[gnu::target("avx2")]] void
+		classify_avx2(const char_class& cls, const char* ptr, std::size_t length, std::uint64_t* words) noexcept {
+			const auto rows_lo = rows256(cls, 0);
+			const auto rows_hi = rows256(cls, 1);
+			const auto bit_of = _mm256_broadcastsi128_si256(bit_of_nibble128());
+			std::size_t i = 0;
+			for (; i + 64 <= length; i += 64) {
+				const auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+				const auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i + 32));
+				words[i / 64] = static_cast<std::uint64_t>(lookup32(lo, rows_lo, rows_hi, bit_of))
+				                | static_cast<std::uint64_t>(lookup32(hi, rows_lo, rows_hi, bit_of)) << 32;
+			}
+			classify_scalar(cls, ptr + i, length - i, words + i / 64);
+		}
+
+		constexpr auto avx2_kernels = kernels{count_avx2, compact_avx2, classify_avx2};
+
+		// AVX-512BW has no byte blend on a vector condition, so the half is picked with the sign bits as a mask, and
+		// the membership bits come straight out as a 64-bit mask.
+		[[gnu::target("avx512f,avx512bw")]] inline auto
+		lookup64(__m512i v, __m512i rows_lo, __m512i rows_hi, __m512i bit_of) noexcept -> std::uint64_t {
+			const auto nibble = _mm512_set1_epi8(0x0f);
+			const auto lo = _mm512_and_si512(v, nibble);
+			const auto hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble);
+			const auto row = _mm512_mask_blend_epi8(_mm512_movepi8_mask(v),
+			                                        _mm512_shuffle_epi8(rows_lo, lo),
+			                                        _mm512_shuffle_epi8(rows_hi, lo));
+			return _mm512_test_epi8_mask(row, _mm512_shuffle_epi8(bit_of, hi));
+		}
+
+		// _mm512_broadcast_i32x4 starts from _mm512_undefined_epi32(), which gcc 12 reports as used uninitialized
+		// once inlined at -O2; the zero-masked form with every lane selected is the same instruction without it
+		[[gnu::target("avx512f")]] inline auto broadcast512(__m128i v) noexcept -> __m512i {
+			return _mm512_maskz_broadcast_i32x4(0xffff, v);
+		}
+
+		[[gnu::target("avx512f,avx512bw")]] inline auto rows512(const char_class& cls, std::size_t half) noexcept
+		    -> __m512i {
+			return broadcast512(rows128(cls, half));
+		}
+
+		[[gnu::target("avx512f,avx512bw,popcnt")]] auto
+		count_avx512(const char_class& cls, const char* ptr, std::size_t length) noexcept -> std::size_t {
+			const auto rows_lo = rows512(cls, 0);
+			const auto rows_hi = rows512(cls, 1);
+			const auto bit_of = broadcast512(bit_of_nibble128());
+			std::size_t soln = 0;
+			std::size_t i = 0;
+			for (; i + 64 <= length; i += 64) {
+				const auto v = _mm512_loadu_si512(ptr + i);
+				soln += static_cast<std::size_t>(std::popcount(lookup64(v, rows_lo, rows_hi, bit_of)));
+			}
+			return soln + count_scalar(cls, ptr + i, length - i);
+		}
+
+		// vpcompressb packs the members of 64 bytes in one instruction; the full-width store needs 64 bytes of room
+		[[gnu::target("avx512f,avx512bw,avx512vbmi2,popcnt")]] auto
+		compact_avx512(const char_class& cls,
+		               const char* ptr,
+		               std::size_t length,
+		               char* out,
+		               std::size_t capacity) noexcept -> std::size_t {
+			const auto rows_lo = rows512(cls, 0);
+			const auto rows_hi = rows512(cls, 1);
+			const auto bit_of = broadcast512(bit_of_nibble128());
+			std::size_t soln = 0;
+			std::size_t i = 0;
+			for (; i + 64 <= length and capacity - soln >= 64; i += 64) {
+				const auto v = _mm512_loadu_si512(ptr + i);
+				const auto mask = lookup64(v, rows_lo, rows_hi, bit_of);
+				_mm512_storeu_si512(out + soln, _mm512_maskz_compress_epi8(mask, v));
+				soln += static_cast<std::size_t>(std::popcount(mask));
+			}
+			return soln + compact_scalar(cls, ptr + i, length - i, out + soln, capacity - soln);
+		}
+
+		[[gnu::target("avx512f,avx512bw")]] void
+		classify_avx512(const char_class& cls, const char* ptr, std::size_t length, std::uint64_t* words) noexcept {
+			const auto rows_lo = rows512(cls, 0);
+			const auto rows_hi = rows512(cls, 1);
+			const auto bit_of = broadcast512(bit_of_nibble128());
+			std::size_t i = 0;
+			for (; i + 64 <= length; i += 64) {
+				words[i / 64] = lookup64(_mm512_loadu_si512(ptr + i), rows_lo, rows_hi, bit_of);
+			}
+			classify_scalar(cls, ptr + i, length - i, words + i / 64);
+		}
+
+		constexpr auto avx512_kernels = kernels{count_avx512, compact_avx512, classify_avx512};
+#endif
+	} // namespace
+
+	auto detected_isa() noexcept -> isa {
+		static const auto level = [] {
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512bw") and __builtin_cpu_supports("avx512vbmi2")
+			    and __builtin_cpu_supports("popcnt")) {
+				return isa::avx512;
+			}
+			if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("popcnt")) {
+				return isa::avx2;
+			}
+			if (__builtin_cpu_supports("sse4.2") and __builtin_cpu_supports("popcnt")) {
+				return isa::sse42;
+			}
+#endif
+			return isa::scalar;
+		}();
+		return level;
+	}
+
+	auto is_supported(isa level) noexcept -> bool {
+		return level <= detected_isa();
+	}
+
+	auto kernels_for(isa level) noexcept -> const kernels& {
+#if defined(__x86_64__) || defined(__i386__)
+		switch (level) {
+		case isa::avx512: return avx512_kernels;
+		case isa::avx2: return avx2_kernels;
+		case isa::sse42: return sse42_kernels;
+		case isa::scalar: break;
+		}
+#else
+		(void)level;
+#endif
+		return scalar_kernels;
+	}
+
+	auto active() noexcept -> const kernels& {
+		static const auto& soln = kernels_for(detected_isa());
+		return soln;
+	}
+} // namespace fsv::detail::simd
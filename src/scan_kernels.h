@@ -0,0 +1,200 @@
+#ifndef COMP6771_ASS2_SCAN_KERNELS_H
+#define COMP6771_ASS2_SCAN_KERNELS_H
+
+#include "./char_class.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace fsv::detail {
+	namespace simd {
+		// Instruction sets the table kernels are compiled for. Anything below the detected level is usable too.
+		enum class isa { scalar, sse42, avx2, avx512 };
+
+		struct kernels {
+			// number of bytes in [ptr, ptr + length) that are members of the class
+			std::size_t (*count)(const char_class& cls, const char* ptr, std::size_t length) noexcept;
+			// copies the members, in order, to out until capacity bytes have been written; returns the number written.
+			// The stores are whole vectors, so out[returned, capacity) may be overwritten too, but nothing after it;
+			// compact_accepted below keeps that inside a buffer of its own.
+			std::size_t (*compact)(const char_class& cls,
+			                       const char* ptr,
+			                       std::size_t length,
+			                       char* out,
+			                       std::size_t capacity) noexcept;
+			// overwrites words[0, ceil(length / 64)) with the membership bitmap: bit (i % 64) of words[i / 64] is set
+			// exactly when ptr[i] is a member, and the bits past length are clear
+			void (*classify)(const char_class& cls, const char* ptr, std::size_t length, std::uint64_t* words) noexcept;
+		};
+
+		[[nodiscard]] auto detected_isa() noexcept -> isa;
+		[[nodiscard]] auto is_supported(isa level) noexcept -> bool;
+		[[nodiscard]] auto kernels_for(isa level) noexcept -> const kernels&;
+		// the kernels for detected_isa(), resolved once per process
+		[[nodiscard]] auto active() noexcept -> const kernels&;
+	} // namespace simd
+
+	// The scanning loops shared by the view's members. The generic versions call the predicate once per byte and are
+	// written without branches on its result so that inlined predicates vectorize; the char_class overloads go to the
+	// SIMD kernels above.
+	template<typename Pred>
+	[[nodiscard]] auto count_accepted(const char* ptr, std::size_t length, const Pred& pred) -> std::size_t {
+		std::size_t soln = 0;
+		for (std::size_t i = 0; i < length; ++i) {
+			soln += static_cast<std::size_t>(static_cast<bool>(pred(ptr[i])));
+		}
+		return soln;
+	}
+
+	[[nodiscard]] inline auto count_accepted(const char* ptr, std::size_t length, const char_class& cls)
+	    -> std::size_t {
+		return simd::active().count(cls, ptr, length);
+	}
+
+	// Runs compact(ptr, length, scratch, room), which may store past the count it returns up to room, a block at a
+	// time into a local buffer, and copies only what it returns to out. Nothing in out past the returned count is
+	// written.
+	template<typename Compact>
+	auto compact_through_block(const char* ptr, std::size_t length, char* out, std::size_t capacity, Compact compact)
+	    -> std::size_t {
+		constexpr std::size_t block = 1024;
+		auto buffer = std::array<char, block>{};
+		std::size_t soln = 0;
+		// a block that fills the rest of out may stop before the end of its input, and then out is full
+		for (std::size_t i = 0; i < length and soln < capacity; i += block) {
+			const std::size_t n =
+			    compact(ptr + i, std::min(block, length - i), buffer.data(), std::min(block, capacity - soln));
+			std::memcpy(out + soln, buffer.data(), n);
+			soln += n;
+		}
+		return soln;
+	}
+
+	// copies the accepted bytes, in order, to out until capacity bytes have been written; returns the number written
+	template<typename Pred>
+	auto compact_accepted(const char* ptr, std::size_t length, const Pred& pred, char* out, std::size_t capacity)
+	    -> std::size_t {
+		// every byte is stored at the next free position and only kept if accepted, so the loop has no branch on the
+		// predicate but writes one byte past the count
+		auto compact = [&pred](const char* in, std::size_t n, char* to, std::size_t room) {
+			std::size_t soln = 0;
+			for (std::size_t i = 0; i < n and soln < room; ++i) {
+				to[soln] = in[i];
+				soln += static_cast<std::size_t>(static_cast<bool>(pred(in[i])));
+			}
+			return soln;
+		};
+		return compact_through_block(ptr, length, out, capacity, compact);
+	}
+
+	inline auto
+	compact_accepted(const char* ptr, std::size_t length, const char_class& cls, char* out, std::size_t capacity)
+	    -> std::size_t {
+		const auto& kernels = simd::active();
+		auto compact = [&](const char* in, std::size_t n, char* to, std::size_t room) {
+			return kernels.compact(cls, in, n, to, room);
+		};
+		return compact_through_block(ptr, length, out, capacity, compact);
+	}
+
+	// Orders n bytes lexicographically as char, which is how the views compare characters, rather than as unsigned
+	// char like memcmp. memcmp still does the work: it skips equal blocks, and only the first block that differs is
+	// compared a character at a time.
+	[[nodiscard]] inline auto compare_chars(const char* lhs, const char* rhs, std::size_t n) noexcept
+	    -> std::strong_ordering {
+		constexpr std::size_t block = 64;
+		for (std::size_t i = 0; i < n; i += block) {
+			const std::size_t m = std::min(block, n - i);
+			if (std::memcmp(lhs + i, rhs + i, m) == 0) {
+				continue;
+			}
+			for (std::size_t j = i;; ++j) {
+				if (lhs[j] != rhs[j]) {
+					return lhs[j] <=> rhs[j];
+				}
+			}
+		}
+		return std::strong_ordering::equal;
+	}
+
+	// The first position in [from, length) whose byte the predicate accepts, or rejects when accepted is false; length
+	// if there is none.
+	template<typename Pred>
+	[[nodiscard]] auto
+	find_accepted(const char* ptr, std::size_t from, std::size_t length, const Pred& pred, bool accepted)
+	    -> std::size_t {
+		while (from < length and static_cast<bool>(pred(ptr[from])) != accepted) {
+			++from;
+		}
+		return from;
+	}
+
+	// Walks the maximal runs of members of a char_class in one buffer, in order. The buffer is classified a batch of
+	// 64-byte words at a time, and each word is turned into a bitmap of the positions where membership changes,
+	// which are the run boundaries, so stepping to the next boundary is a count of trailing zeros. Each byte is
+	// classified once however short the runs are, and no step waits on the one before it.
+	class run_scanner {
+	 public:
+		static constexpr std::size_t batch_words = 8;
+
+		// The raw offsets [first, last) of the run after the one returned by the previous call, or of the first run
+		// on the first call; {length, length} once there are no more. Every call on one scanner must pass the same
+		// buffer and class.
+		[[nodiscard]] auto next(const char* ptr, std::size_t length, const char_class& cls) noexcept
+		    -> std::pair<std::size_t, std::size_t> {
+			const auto first = next_boundary(ptr, length, cls);
+			if (first == length) {
+				return {length, length};
+			}
+			return {first, next_boundary(ptr, length, cls)};
+		}
+
+	 private:
+		// the next position whose byte differs in membership from the byte before it, the byte before the buffer
+		// counting as a non-member; length if there is none
+		[[nodiscard]] auto next_boundary(const char* ptr, std::size_t length, const char_class& cls) noexcept
+		    -> std::size_t {
+			while (boundaries_ == 0) {
+				if (word_ == loaded_) {
+					const std::size_t from = first_ + 64 * loaded_;
+					if (from >= length) {
+						return length;
+					}
+					const std::size_t n = std::min(64 * batch_words, length - from);
+					simd::active().classify(cls, ptr + from, n, words_.data());
+					first_ = from;
+					loaded_ = (n + 63) / 64;
+					word_ = 0;
+				}
+				const auto members = words_[word_];
+				boundaries_ = members ^ (members << 1 | carry_);
+				carry_ = members >> 63;
+				base_ = first_ + 64 * word_;
+				++word_;
+			}
+			const auto soln = base_ + static_cast<std::size_t>(std::countr_zero(boundaries_));
+			boundaries_ &= boundaries_ - 1;
+			// bits past length are clear, so a run reaching the end of a partial word ends at length
+			return std::min(soln, length);
+		}
+
+		std::array<std::uint64_t, batch_words> words_ = {};
+		// raw offset of the first byte of the batch, the number of its words that are classified and the next word
+		std::size_t first_ = 0;
+		std::size_t loaded_ = 0;
+		std::size_t word_ = 0;
+		// the boundaries of the current word not yet returned, and the raw offset of its first byte
+		std::uint64_t boundaries_ = 0;
+		std::size_t base_ = 0;
+		// membership of the last byte of the previous word
+		std::uint64_t carry_ = 0;
+	};
+} // namespace fsv::detail
+
+#endif // COMP6771_ASS2_SCAN_KERNELS_H
@@ -0,0 +1,177 @@
+#include "./scan_kernels.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	using fsv::detail::simd::isa;
+
+	auto random_bytes(std::size_t length, std::mt19937& gen) -> std::string {
+		auto dist = std::uniform_int_distribution<int>{0, 255};
+		auto soln = std::string(length, '\0');
+		for (auto& c : soln) {
+			c = static_cast<char>(dist(gen));
+		}
+		return soln;
+	}
+
+	auto random_class(std::mt19937& gen) -> fsv::char_class {
+		auto dist = std::uniform_int_distribution<int>{0, 3};
+		auto soln = fsv::char_class{};
+		for (int b = 0; b < 256; ++b) {
+			if (dist(gen) != 0) {
+				soln.insert(static_cast<unsigned char>(b));
+			}
+		}
+		return soln;
+	}
+
+	auto reference_compact(const fsv::char_class& cls, const std::string& s) -> std::string {
+		auto soln = std::string{};
+		for (auto c : s) {
+			if (cls(c)) {
+				soln += c;
+			}
+		}
+		return soln;
+	}
+} // namespace
+
+TEST_CASE("every supported kernel agrees with the table") {
+	auto gen = std::mt19937{6771};
+	for (auto level : {isa::scalar, isa::sse42, isa::avx2, isa::avx512}) {
+		if (not fsv::detail::simd::is_supported(level)) {
+			continue;
+		}
+		const auto& k = fsv::detail::simd::kernels_for(level);
+		for (std::size_t length : {0u, 1u, 15u, 16u, 31u, 32u, 33u, 63u, 64u, 65u, 127u, 128u, 129u, 1000u, 4099u}) {
+			const auto buffer = random_bytes(length, gen);
+			const auto cls = random_class(gen);
+			const auto expected = reference_compact(cls, buffer);
+
+			REQUIRE(k.count(cls, buffer.data(), buffer.size()) == expected.size());
+
+			auto out = std::string(expected.size(), '\0');
+			REQUIRE(k.compact(cls, buffer.data(), buffer.size(), out.data(), out.size()) == expected.size());
+			REQUIRE(out == expected);
+
+			// classify overwrites whatever the words held
+			auto words = std::vector<std::uint64_t>((length + 63) / 64, ~std::uint64_t{0});
+			k.classify(cls, buffer.data(), buffer.size(), words.data());
+			for (std::size_t i = 0; i < length; ++i) {
+				REQUIRE(((words[i / 64] >> (i % 64)) & 1) == (cls(buffer[i]) ? 1u : 0u));
+			}
+			if (length % 64 != 0) {
+				REQUIRE(words.back() >> (length % 64) == 0);
+			}
+		}
+	}
+}
+
+TEST_CASE("compaction stops at the capacity of the destination") {
+	const auto buffer = std::string(200, 'x');
+	const auto cls = fsv::char_class{}.insert('x');
+	for (auto level : {isa::scalar, isa::sse42, isa::avx2, isa::avx512}) {
+		if (not fsv::detail::simd::is_supported(level)) {
+			continue;
+		}
+		// guard bytes after the destination must survive the wide stores
+		auto out = std::string(77 + 32, '#');
+		const auto& k = fsv::detail::simd::kernels_for(level);
+		const auto written = k.compact(cls, buffer.data(), buffer.size(), out.data(), 77);
+		REQUIRE(written == 77);
+		REQUIRE(out == std::string(77, 'x') + std::string(32, '#'));
+	}
+}
+
+TEST_CASE("compaction only overwrites the destination up to its capacity") {
+	const auto buffer = std::string(40, 'a') + std::string(40, '-');
+	const auto cls = fsv::char_class{}.insert('a');
+	for (auto level : {isa::scalar, isa::sse42, isa::avx2, isa::avx512}) {
+		if (not fsv::detail::simd::is_supported(level)) {
+			continue;
+		}
+		// out[40, 50) is scratch for the wide stores, and the guard bytes after it must survive them
+		auto out = std::string(50 + 64, '#');
+		const auto& k = fsv::detail::simd::kernels_for(level);
+		REQUIRE(k.compact(cls, buffer.data(), buffer.size(), out.data(), 50) == 40);
+		REQUIRE(out.substr(0, 40) == std::string(40, 'a'));
+		REQUIRE(out.substr(50) == std::string(64, '#'));
+	}
+}
+
+TEST_CASE("compact_accepted writes nothing past the count it returns") {
+	auto buffer = std::string{};
+	for (int i = 0; i < 1000; ++i) {
+		buffer += i % 3 == 0 ? "--" : "a-";
+	}
+	const auto cls = fsv::char_class{}.insert('a');
+	auto is_a = [](const char& c) { return c == 'a'; };
+	for (const auto capacity : {std::size_t{0}, std::size_t{1}, std::size_t{100}, std::size_t{1024}, buffer.size()}) {
+		const auto expected = std::min<std::size_t>(capacity, 666);
+		auto by_table = std::string(buffer.size(), '#');
+		auto by_lambda = by_table;
+		REQUIRE(fsv::detail::compact_accepted(buffer.data(), buffer.size(), cls, by_table.data(), capacity) == expected);
+		REQUIRE(fsv::detail::compact_accepted(buffer.data(), buffer.size(), is_a, by_lambda.data(), capacity)
+		        == expected);
+		CHECK(by_table == std::string(expected, 'a') + std::string(buffer.size() - expected, '#'));
+		CHECK(by_lambda == by_table);
+	}
+}
+
+TEST_CASE("the sign bit of a byte selects the upper half of the table") {
+	auto cls = fsv::char_class{};
+	cls.insert(0x41).insert(0xc1);
+	const auto buffer = std::string(64, static_cast<char>(0xc1)) + std::string(64, 0x41) + std::string(64, 0x01);
+	for (auto level : {isa::scalar, isa::sse42, isa::avx2, isa::avx512}) {
+		if (fsv::detail::simd::is_supported(level)) {
+			REQUIRE(fsv::detail::simd::kernels_for(level).count(cls, buffer.data(), buffer.size()) == 128);
+		}
+	}
+}
+
+TEST_CASE("run_scanner yields the runs the scalar search finds") {
+	auto gen = std::mt19937{7};
+	for (std::size_t length : {0u, 1u, 63u, 64u, 65u, 200u, 511u, 512u, 513u, 5000u, 20000u}) {
+		const auto bytes = random_bytes(length, gen);
+		for (int density = 0; density < 5; ++density) {
+			// mostly-accepting and mostly-rejecting classes give long runs of both kinds
+			auto cls = density == 0 ? fsv::char_class{} : random_class(gen);
+			if (density == 3) {
+				cls = ~cls;
+			}
+			if (density == 4) {
+				cls = fsv::char_class::all();
+			}
+			auto pred = [&cls](const char& c) { return cls(c); };
+			auto scanner = fsv::detail::run_scanner{};
+			for (std::size_t from = 0;;) {
+				const auto first = fsv::detail::find_accepted(bytes.data(), from, length, pred, true);
+				const auto last = first == length ? length
+				                                  : fsv::detail::find_accepted(bytes.data(), first + 1, length, pred, false);
+				REQUIRE(scanner.next(bytes.data(), length, cls) == std::pair{first, last});
+				if (first == length) {
+					break;
+				}
+				from = last;
+			}
+			REQUIRE(scanner.next(bytes.data(), length, cls) == std::pair{length, length});
+		}
+	}
+}
+
+TEST_CASE("run_scanner walks alternating runs") {
+	auto bytes = std::string(1000, '-');
+	for (std::size_t i = 0; i < bytes.size(); i += 2) {
+		bytes[i] = 'x';
+	}
+	const auto cls = fsv::char_class{}.insert('x');
+	auto scanner = fsv::detail::run_scanner{};
+	for (std::size_t i = 0; i < 500; ++i) {
+		REQUIRE(scanner.next(bytes.data(), bytes.size(), cls) == std::pair{2 * i, 2 * i + 1});
+	}
+	REQUIRE(scanner.next(bytes.data(), bytes.size(), cls) == std::pair{bytes.size(), bytes.size()});
+}
@@ -0,0 +1,160 @@
+#include "./string_search.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace fsv::detail {
+	namespace {
+		// Start (minus one) and period of the maximal suffix of the needle under the byte order, or under the
+		// reversed order when reversed is set.
+		auto maximal_suffix(const std::string& x, bool reversed, std::ptrdiff_t& period) noexcept -> std::ptrdiff_t {
+			const auto m = static_cast<std::ptrdiff_t>(x.size());
+			auto at = [&x](std::ptrdiff_t i) { return static_cast<unsigned char>(x[static_cast<std::size_t>(i)]); };
+			std::ptrdiff_t ms = -1;
+			std::ptrdiff_t j = 0;
+			std::ptrdiff_t k = 1;
+			period = 1;
+			while (j + k < m) {
+				const auto a = at(j + k);
+				const auto b = at(ms + k);
+				if (reversed ? a > b : a < b) {
+					j += k;
+					k = 1;
+					period = j - ms;
+				}
+				else if (a == b) {
+					if (k != period) {
+						++k;
+					}
+					else {
+						j += period;
+						k = 1;
+					}
+				}
+				else {
+					ms = j;
+					j = ms + 1;
+					k = period = 1;
+				}
+			}
+			return ms;
+		}
+	} // namespace
+
+	two_way_searcher::two_way_searcher(std::string needle)
+	: needle_{std::move(needle)}
+	, critical_{-1}
+	, period_{1}
+	, periodic_{false} {
+		if (needle_.size() < 2) {
+			return;
+		}
+		std::ptrdiff_t p = 0;
+		std::ptrdiff_t q = 0;
+		const auto i = maximal_suffix(needle_, false, p);
+		const auto j = maximal_suffix(needle_, true, q);
+		critical_ = (i > j) ? i : j;
+		period_ = (i > j) ? p : q;
+
+		const auto m = static_cast<std::ptrdiff_t>(needle_.size());
+		const auto left = static_cast<std::size_t>(critical_ + 1);
+		periodic_ = period_ + critical_ + 1 <= m and std::memcmp(needle_.data(), needle_.data() + period_, left) == 0;
+		if (not periodic_) {
+			period_ = std::max(critical_ + 1, m - critical_ - 1) + 1;
+		}
+	}
+
+	auto two_way_searcher::operator()(const char* first, const char* last) const noexcept -> const char* {
+		const auto m = static_cast<std::ptrdiff_t>(needle_.size());
+		const auto n = last - first;
+		if (m == 0) {
+			return first;
+		}
+		if (m > n) {
+			return last;
+		}
+		if (m == 1) {
+			const auto* found = std::memchr(first, needle_[0], static_cast<std::size_t>(n));
+			return found == nullptr ? last : static_cast<const char*>(found);
+		}
+
+		const char* x = needle_.data();
+		const std::ptrdiff_t ell = critical_;
+		std::ptrdiff_t j = 0;
+		if (periodic_) {
+			// memory is how much of the needle's left part is known to match after a shift by the period
+			std::ptrdiff_t memory = -1;
+			while (j <= n - m) {
+				auto i = std::max(ell, memory) + 1;
+				while (i < m and x[i] == first[i + j]) {
+					++i;
+				}
+				if (i >= m) {
+					i = ell;
+					while (i > memory and x[i] == first[i + j]) {
+						--i;
+					}
+					if (i <= memory) {
+						return first + j;
+					}
+					j += period_;
+					memory = m - period_ - 1;
+				}
+				else {
+					j += i - ell;
+					memory = -1;
+				}
+			}
+		}
+		else {
+			while (j <= n - m) {
+				auto i = ell + 1;
+				while (i < m and x[i] == first[i + j]) {
+					++i;
+				}
+				if (i >= m) {
+					i = ell;
+					while (i >= 0 and x[i] == first[i + j]) {
+						--i;
+					}
+					if (i < 0) {
+						return first + j;
+					}
+					j += period_;
+				}
+				else {
+					j += i - ell;
+				}
+			}
+		}
+		return last;
+	}
+
+	stream_matcher::stream_matcher(std::string needle)
+	: needle_{std::move(needle)}
+	, failure_(needle_.size(), 0) {
+		for (std::size_t i = 1, k = 0; i < needle_.size(); ++i) {
+			while (k > 0 and needle_[i] != needle_[k]) {
+				k = failure_[k - 1];
+			}
+			if (needle_[i] == needle_[k]) {
+				++k;
+			}
+			failure_[i] = k;
+		}
+	}
+
+	auto stream_matcher::step(std::size_t state, char c) const noexcept -> std::size_t {
+		if (state == needle_.size()) {
+			state = failure_[state - 1];
+		}
+		while (state > 0 and needle_[state] != c) {
+			state = failure_[state - 1];
+		}
+		return needle_[state] == c ? state + 1 : state;
+	}
+
+	auto stream_matcher::size() const noexcept -> std::size_t {
+		return needle_.size();
+	}
+} // namespace fsv::detail
@@ -0,0 +1,43 @@
+#ifndef COMP6771_ASS2_STRING_SEARCH_H
+#define COMP6771_ASS2_STRING_SEARCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace fsv::detail {
+	// Crochemore-Perrin Two-Way search over contiguous memory: linear time, constant extra space once the critical
+	// factorisation of the needle is known, and no per-alphabet tables. Single-byte needles go to memchr instead.
+	class two_way_searcher {
+	 public:
+		explicit two_way_searcher(std::string needle);
+
+		// the first occurrence of the needle in [first, last), or last if there is none
+		[[nodiscard]] auto operator()(const char* first, const char* last) const noexcept -> const char*;
+
+	 private:
+		std::string needle_;
+		// the needle is split as needle_[0, critical_ + 1) and needle_[critical_ + 1, size)
+		std::ptrdiff_t critical_;
+		std::ptrdiff_t period_;
+		bool periodic_;
+	};
+
+	// Knuth-Morris-Pratt over a stream of characters fed one at a time, for haystacks that are not contiguous in
+	// memory, such as the accepted bytes of a filtered view.
+	class stream_matcher {
+	 public:
+		explicit stream_matcher(std::string needle);
+
+		// The state is the length of the needle prefix matched so far, starting from zero. Returns the state after c;
+		// the needle ends at c when that equals size().
+		[[nodiscard]] auto step(std::size_t state, char c) const noexcept -> std::size_t;
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+	 private:
+		std::string needle_;
+		std::vector<std::size_t> failure_;
+	};
+} // namespace fsv::detail
+
+#endif // COMP6771_ASS2_STRING_SEARCH_H
@@ -0,0 +1,83 @@
+#include "./string_search.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+	// every string of length up to max_length over the given alphabet
+	auto all_strings(const std::string& alphabet, std::size_t max_length) -> std::vector<std::string> {
+		auto soln = std::vector<std::string>{""};
+		for (std::size_t begin = 0; begin < soln.size(); ++begin) {
+			if (soln[begin].size() == max_length) {
+				continue;
+			}
+			for (auto c : alphabet) {
+				soln.push_back(soln[begin] + c);
+			}
+		}
+		return soln;
+	}
+} // namespace
+
+TEST_CASE("two_way_searcher agrees with std::search") {
+	const auto needles = all_strings("ab", 6);
+	const auto haystacks = all_strings("ab", 9);
+	for (const auto& needle : needles) {
+		const auto searcher = fsv::detail::two_way_searcher{needle};
+		for (const auto& haystack : haystacks) {
+			const char* first = haystack.data();
+			const char* last = first + haystack.size();
+			const auto* expected = std::search(first, last, needle.begin(), needle.end());
+			if (expected != searcher(first, last)) {
+				FAIL("needle \"" << needle << "\" in \"" << haystack << "\"");
+			}
+		}
+	}
+}
+
+TEST_CASE("two_way_searcher handles periodic and high-byte needles") {
+	auto haystack = std::string(5000, 'a') + "\xff\x80" + std::string(5000, 'a') + "abaabaab";
+	for (const auto* needle : {"abaabaab", "aaaaaaaaaaab", "\xff\x80", "a\xff\x80"}) {
+		const auto searcher = fsv::detail::two_way_searcher{needle};
+		const auto* expected = std::search(haystack.data(),
+		                                   haystack.data() + haystack.size(),
+		                                   needle,
+		                                   needle + std::char_traits<char>::length(needle));
+		CHECK(searcher(haystack.data(), haystack.data() + haystack.size()) == expected);
+	}
+}
+
+TEST_CASE("stream_matcher reports non-overlapping matches") {
+	const auto needles = all_strings("ab", 4);
+	const auto haystacks = all_strings("ab", 8);
+	for (const auto& needle : needles) {
+		if (needle.empty()) {
+			continue;
+		}
+		const auto matcher = fsv::detail::stream_matcher{needle};
+		for (const auto& haystack : haystacks) {
+			auto expected = std::vector<std::size_t>{};
+			for (auto pos = haystack.find(needle); pos != std::string::npos;) {
+				expected.push_back(pos + needle.size());
+				pos = haystack.find(needle, pos + needle.size());
+			}
+
+			auto found = std::vector<std::size_t>{};
+			std::size_t state = 0;
+			for (std::size_t i = 0; i < haystack.size(); ++i) {
+				state = matcher.step(state, haystack[i]);
+				if (state == matcher.size()) {
+					found.push_back(i + 1);
+					state = 0;
+				}
+			}
+			if (expected != found) {
+				FAIL("needle \"" << needle << "\" in \"" << haystack << "\"");
+			}
+		}
+	}
+}